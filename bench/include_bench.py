@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""
+Build time of a generated project using type_util.h three ways
+
+  include - every TU does #include "type_util.h"
+  pch     - type_util.h is precompiled once and every TU uses the PCH
+  module  - type_util.cppm is built once and every TU does `import t;`
+
+Generates --tus TUs (200 by default), each instantiating a few t:: metafunctions on
+its own inputs, compiles them to objects with -j jobs and reports the wall time of
+the one-off step (PCH or module), of all the TUs, and their summed CPU time.
+
+Usage:
+    bench/include_bench.py [-o results.json] [--cxx g++] [--tus 200] [-j 8]
+                           [--modes include,pch,module]
+
+Output is a JSON document:
+    { "compiler": ..., "tus": 200, "results": [
+        { "mode": "pch", "ok": true, "prepare_wall_s": ..., "build_wall_s": ...,
+          "build_cpu_s": ..., "per_tu_cpu_s": ... }, ... ] }
+A mode the compiler does not support is recorded with "ok": false and its first
+error line.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+MODES = ["include", "pch", "module"]
+
+HEADERS = {
+    "include": '#include "type_util.h"\n#include <tuple>\n#include <utility>\n',
+    "pch":     "#include <tuple>\n#include <utility>\n",  # type_util.h comes with -include
+    "module":  "#include <tuple>\n#include <utility>\nimport t;\n",
+}
+
+BODY = """\
+namespace tu_@I@ {
+
+template <int I> struct tag { char pad[I % 7 + 1]; };
+
+template <class Is> struct make_input;
+template <std::size_t... Is> struct make_input<std::index_sequence<Is...>> {
+    using type = std::tuple<tag<int(Is) + @I@>...>;
+};
+
+using input = make_input<std::make_index_sequence<32>>::type;
+using seq   = t::seq_t<int, (@I@ * 7) % 13, 5, (@I@ * 3) % 11, 1, 9, @I@>;
+
+static_assert(t::size_v<t::reverse_t<input>> == 32);
+static_assert(t::find_v<input, tag<@I@ + 3>> == 3);
+static_assert(t::size_v<t::skip_t<4, input>> == 28);
+static_assert(t::size_v<t::unique_t<t::concat_t<input, input>>> == 32);
+static_assert(t::select_v<0, t::sorted_t<seq>> <= 1);
+using sorted = t::sort_by_t<input, t::sizeof_key>;
+
+sorted* use() { return nullptr; }
+
+}  // namespace tu_@I@
+"""
+
+
+def run(cmd, cwd):
+    proc = subprocess.Popen(cmd, cwd=cwd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    stderr = proc.stderr.read()
+    _, status, rusage = os.wait4(proc.pid, 0)
+    code = os.waitstatus_to_exitcode(status)
+    error = None
+    if code != 0:
+        lines = [l for l in stderr.decode(errors="replace").splitlines() if "error" in l]
+        error = lines[0] if lines else "exit code %d" % code
+    return error, rusage.ru_utime + rusage.ru_stime
+
+
+def is_clang(cxx):
+    out = subprocess.run([cxx, "--version"], capture_output=True, text=True).stdout
+    return "clang" in out
+
+
+def prepare(mode, cxx, std, flags, workdir, clang):
+    """Builds the PCH or module. Returns (error, extra flags for the TUs)."""
+    if mode == "include":
+        return None, ["-I", ROOT]
+    if mode == "pch":
+        # GCC looks for type_util.h.gch next to the header it is asked to include
+        header = os.path.join(workdir, "type_util.h")
+        shutil.copy(os.path.join(ROOT, "type_util.h"), header)
+        shutil.copy(os.path.join(ROOT, "type_util_impl.h"), workdir)
+        if clang:
+            pch = os.path.join(workdir, "type_util.pch")
+            error, _ = run([cxx, "-std=" + std] + flags + ["-x", "c++-header", header, "-o", pch], workdir)
+            return error, ["-include-pch", pch]
+        error, _ = run([cxx, "-std=" + std] + flags + ["-x", "c++-header", header,
+                                                       "-o", header + ".gch"], workdir)
+        return error, ["-include", header]
+    # module - at least C++20
+    std = std if int(re.sub(r"\D", "", std) or 0) >= 20 else "c++20"
+    src = os.path.join(ROOT, "type_util.cppm")
+    if clang:
+        pcm = os.path.join(workdir, "t.pcm")
+        error, _ = run([cxx, "-std=" + std] + flags + ["-I", ROOT, "--precompile", src, "-o", pcm],
+                       workdir)
+        return error, ["-std=" + std, "-fmodule-file=t=" + pcm]
+    error, _ = run([cxx, "-std=" + std, "-fmodules-ts"] + flags +
+                   ["-I", ROOT, "-x", "c++", "-c", src, "-o", os.path.join(workdir, "t.o")], workdir)
+    return error, ["-std=" + std, "-fmodules-ts"]
+
+
+def bench_mode(mode, cxx, std, flags, tus, jobs, clang):
+    workdir = tempfile.mkdtemp(prefix="include_bench_%s_" % mode)
+    try:
+        sources = []
+        for i in range(tus):
+            src = os.path.join(workdir, "tu_%d.cpp" % i)
+            with open(src, "w") as f:
+                f.write(HEADERS[mode] + BODY.replace("@I@", str(i)))
+            sources.append(src)
+
+        start = time.perf_counter()
+        error, extra = prepare(mode, cxx, std, flags, workdir, clang)
+        prepare_wall = time.perf_counter() - start
+        result = {"mode": mode, "prepare_wall_s": round(prepare_wall, 3)}
+        if error:
+            result.update(ok=False, error=error)
+            return result
+
+        # The later -std wins, so the module's C++20 overrides --std
+        cmd = [cxx, "-std=" + std] + flags + extra
+        start = time.perf_counter()
+        with ThreadPoolExecutor(max_workers=jobs) as pool:
+            runs = list(pool.map(lambda s: run(cmd + ["-c", s, "-o", s + ".o"], workdir), sources))
+        build_wall = time.perf_counter() - start
+
+        errors = [e for e, _ in runs if e]
+        cpu = sum(c for _, c in runs)
+        result.update(ok=not errors, build_wall_s=round(build_wall, 3), build_cpu_s=round(cpu, 3),
+                      per_tu_cpu_s=round(cpu / tus, 4))
+        if errors:
+            result["error"] = errors[0]
+        return result
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("-o", "--output", default="include_bench.json")
+    ap.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    ap.add_argument("--std", default="c++17")
+    ap.add_argument("--flags", default="-O0", help="extra compiler flags, space separated")
+    ap.add_argument("--tus", type=int, default=200)
+    ap.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1)
+    ap.add_argument("--modes", default=",".join(MODES))
+    args = ap.parse_args()
+
+    flags = args.flags.split()
+    modes = [m for m in args.modes.split(",") if m]
+    for m in modes:
+        if m not in MODES:
+            sys.exit("unknown mode '%s', expected one of: %s" % (m, ", ".join(MODES)))
+
+    clang = is_clang(args.cxx)
+    results = []
+    for mode in modes:
+        r = bench_mode(mode, args.cxx, args.std, flags, args.tus, args.jobs, clang)
+        results.append(r)
+        if r["ok"]:
+            print("%-8s prepare %7.3fs  build %7.3fs  cpu %8.3fs  %.4fs/TU" % (
+                mode, r["prepare_wall_s"], r["build_wall_s"], r["build_cpu_s"], r["per_tu_cpu_s"]),
+                file=sys.stderr)
+        else:
+            print("%-8s FAIL %s" % (mode, r["error"]), file=sys.stderr)
+
+    with open(args.output, "w") as f:
+        json.dump({"compiler": args.cxx,
+                   "compiler_version": subprocess.run([args.cxx, "--version"], capture_output=True,
+                                                      text=True).stdout.splitlines()[0],
+                   "std": args.std,
+                   "flags": flags,
+                   "tus": args.tus,
+                   "results": results}, f, indent=1)
+        f.write("\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,84 @@
+// Runtime lower_bound of sorted seq_v constants - t::search_table (Eytzinger order,
+// branchless, prefetching) against std::lower_bound on the plain sorted array.
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -march=native -I. bench/search_table_bench.cpp -o search_table_bench
+//     ./search_table_bench
+//
+// Prints one line per (sequence size, method) with nanoseconds per lookup. Queries
+// are uniform over the range of the constants, so about every one falls between two.
+
+#include "search_table.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+// N increasing thresholds with uneven gaps
+template <size_t N>
+struct thresholds {
+    static constexpr std::array<int, N> value = [] {
+        std::array<int, N> a{};
+        int v = 0;
+        for (size_t i = 0; i < N; ++i) {
+            v += 1 + int((i * 2654435761u) % 97);
+            a[i] = v;
+        }
+        return a;
+    }();
+};
+
+template <class Seq>
+std::vector<int> make_queries(size_t count) {
+    constexpr auto& a = t::to_array_v<Seq>;
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> dist(a.front() - 10, a.back() + 10);
+    std::vector<int> q(count);
+    for (auto& v : q) v = dist(rng);
+    return q;
+}
+
+template <class F>
+double ns_per_query(size_t count, F&& f) {
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < 20; ++rep) sink += f();
+    auto stop = std::chrono::steady_clock::now();
+    asm volatile("" : : "r"(sink));
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (20.0 * count);
+}
+
+template <size_t N>
+void run() {
+    using seq = t::to_seq_t<thresholds<N>>;
+    constexpr auto& a = t::to_array_v<seq>;
+    auto q = make_queries<seq>(1 << 18);
+
+    double std_ns = ns_per_query(q.size(), [&] {
+        size_t s = 0;
+        for (int v : q) s += std::lower_bound(a.begin(), a.end(), v) - a.begin();
+        return s;
+    });
+    double table_ns = ns_per_query(q.size(), [&] {
+        size_t s = 0;
+        for (int v : q) s += t::search_table<seq>::rank(v);
+        return s;
+    });
+    std::printf("n=%-6zu %-18s %7.2f ns\n", N, "std::lower_bound", std_ns);
+    std::printf("n=%-6zu %-18s %7.2f ns\n\n", N, "search_table", table_ns);
+}
+
+} // namespace
+
+int main() {
+    run<16>();
+    run<256>();
+    run<4096>();
+    run<16384>();
+    run<65536>();
+}
@@ -0,0 +1,108 @@
+// Runtime search of seq_v constants - t::index_of with each seq_search_kind against
+// std::find on the same array.
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -march=native -I. bench/seq_search_bench.cpp -o seq_search_bench
+//     ./seq_search_bench
+//
+// Prints one line per (sequence, method) with nanoseconds per lookup. Half the
+// queries are hits, at random positions.
+
+#include "seq_search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// N sparse values - a scrambled multiplicative pattern
+template <class T, class Is> struct make_sparse;
+template <class T, size_t... Is> struct make_sparse<T, std::index_sequence<Is...>> {
+    using type = t::seq_t<T, T((Is * 2654435761u) % 1000003u)...>;
+};
+
+// N values in a range of 2N
+template <class T, class Is> struct make_dense;
+template <class T, size_t... Is> struct make_dense<T, std::index_sequence<Is...>> {
+    using type = t::seq_t<T, T((Is * 7) % (2 * sizeof...(Is)))...>;
+};
+
+template <class Seq>
+std::vector<typename Seq::value_type> make_queries(size_t count) {
+    constexpr auto a = t::detail::seq_search<Seq>::a;
+    std::mt19937 rng(12345);
+    std::vector<typename Seq::value_type> q(count);
+    for (auto& v : q) {
+        v = rng() % 2 ? a[rng() % a.size()] : typename Seq::value_type(rng());
+    }
+    return q;
+}
+
+template <class F>
+double ns_per_query(size_t count, F&& f) {
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < 20; ++rep) sink += f();
+    auto stop = std::chrono::steady_clock::now();
+    asm volatile("" : : "r"(sink));
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (20.0 * count);
+}
+
+const char* kind_name(t::seq_search_kind k) {
+    switch (k) {
+    case t::seq_search_kind::unrolled: return "unrolled";
+    case t::seq_search_kind::bitmap:   return "bitmap";
+    case t::seq_search_kind::simd:     return "simd";
+    case t::seq_search_kind::scalar:   return "scalar";
+    }
+    return "?";
+}
+
+template <class Seq, t::seq_search_kind Kind>
+void run_kind(const char* name, const std::vector<typename Seq::value_type>& q) {
+    double ns = ns_per_query(q.size(), [&] {
+        size_t s = 0;
+        for (auto v : q) s += t::index_of<Seq, Kind>(v);
+        return s;
+    });
+    std::printf("%-16s n=%-5zu %-10s %7.2f ns\n", name, t::size_v<Seq>, kind_name(Kind), ns);
+}
+
+template <class Seq>
+void run(const char* name) {
+    auto q = make_queries<Seq>(1 << 16);
+    constexpr auto a = t::detail::seq_search<Seq>::a;
+    double ns = ns_per_query(q.size(), [&] {
+        size_t s = 0;
+        for (auto v : q) s += std::find(a.begin(), a.end(), v) - a.begin();
+        return s;
+    });
+    std::printf("%-16s n=%-5zu %-10s %7.2f ns\n", name, t::size_v<Seq>, "std::find", ns);
+
+    using search = t::detail::seq_search<Seq>;
+    run_kind<Seq, t::seq_search_kind::scalar>(name, q);
+    run_kind<Seq, t::seq_search_kind::simd>(name, q);
+    if constexpr (search::span < t::detail::seq_search_bitmap_range) {
+        run_kind<Seq, t::seq_search_kind::bitmap>(name, q);
+    }
+    if constexpr (search::n <= 32) {
+        run_kind<Seq, t::seq_search_kind::unrolled>(name, q);
+    }
+    std::printf("%-16s n=%-5zu default is %s\n\n", name, t::size_v<Seq>, kind_name(t::seq_search_v<Seq>));
+}
+
+} // namespace
+
+int main() {
+    run<make_sparse<int,     std::make_index_sequence<8>>::type>("sparse int");
+    run<make_sparse<int,     std::make_index_sequence<32>>::type>("sparse int");
+    run<make_sparse<int,     std::make_index_sequence<128>>::type>("sparse int");
+    run<make_sparse<int,     std::make_index_sequence<512>>::type>("sparse int");
+    run<make_sparse<int64_t, std::make_index_sequence<128>>::type>("sparse int64");
+    run<make_dense<short,    std::make_index_sequence<64>>::type>("dense short");
+    run<make_dense<int,      std::make_index_sequence<256>>::type>("dense int");
+}
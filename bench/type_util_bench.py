@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""
+Compile-time benchmark for the t:: metafunctions in type_util.h
+
+Generates one TU per (operation, input kind, N), compiles it with -fsyntax-only
+and records wall time, peak compiler memory and, when the compiler supports
+-ftime-trace (clang), the number of template instantiations.
+Each TU is measured against a baseline TU that only builds the input, so the
+"delta" fields are the cost of the operation itself.
+
+Usage:
+    bench/type_util_bench.py [-o results.json] [--cxx g++] [--sizes 8,16,...]
+                             [--ops select_t,skip_t,...] [--repeat 3]
+                             [--max-wall 5]
+
+Output is a JSON document:
+    { "compiler": ..., "flags": [...], "results": [
+        { "op": "skip_t", "kind": "tuple", "n": 256, "ok": true,
+          "wall_s": ..., "max_rss_kb": ..., "instantiations": ...,
+          "delta_wall_s": ..., "delta_max_rss_kb": ..., "delta_instantiations": ... },
+        ... ] }
+Failed compilations (e.g. -ftemplate-depth exceeded) are recorded with
+"ok": false and the first error line, so the scaling limit shows up too.
+
+With --max-wall, the script exits non-zero when any TU fails or takes longer than
+that many seconds, e.g. to catch a quadratic concat_t at N=2048:
+    bench/type_util_bench.py --ops concat_t --sizes 2048 --max-wall 5
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+DEFAULT_SIZES = [8, 16, 32, 64, 128, 256, 512, 1024, 2048]
+
+PRELUDE = """\
+#include "type_util.h"
+#include <utility>
+
+template <int I> struct tag {};
+
+template <class T, class> struct is_even_tag;
+template <int I, class P> struct is_even_tag<tag<I>, P> { static constexpr bool value = I % 2 == 0; };
+template <int I, class P> struct is_even_tag<t::seq_t<int, I>, P> { static constexpr bool value = I % 2 == 0; };
+
+template <class Is> struct make_tuple_input;
+template <size_t... Is> struct make_tuple_input<std::index_sequence<Is...>> {
+    using type = std::tuple<tag<int(Is)>...>;
+};
+
+template <class Is> struct make_seq_input;
+template <size_t... Is> struct make_seq_input<std::index_sequence<Is...>> {
+    // Scrambled so sorting has work to do
+    using type = t::seq_t<int, int((Is * 7919) % sizeof...(Is))...>;
+};
+
+// N one-element arguments, built by expansion so the input costs no lookups
+template <class Is> struct concat_tuple_singles;
+template <size_t... Is> struct concat_tuple_singles<std::index_sequence<Is...>> {
+    using type = t::concat_t<std::tuple<tag<int(Is)>>...>;
+};
+
+template <class Is> struct concat_seq_singles;
+template <size_t... Is> struct concat_seq_singles<std::index_sequence<Is...>> {
+    using type = t::concat_t<t::seq_t<int, int(Is)>...>;
+};
+
+static constexpr int N = @N@;
+using tuple_input = make_tuple_input<std::make_index_sequence<N>>::type;
+using seq_input   = make_seq_input<std::make_index_sequence<N>>::type;
+"""
+
+# Operation -> {kind: body}. Bodies must force instantiation of the result.
+OPS = {
+    "select_t": {
+        "tuple": "using result = t::select_t<N - 1, tuple_input>; result* sink = nullptr;",
+        "seq":   "using result = t::select_t<N - 1, seq_input>; result* sink = nullptr;",
+    },
+    "skip_t": {
+        "tuple": "using result = t::skip_t<N / 2, tuple_input>; result* sink = nullptr;",
+        "seq":   "using result = t::skip_t<N / 2, seq_input>; result* sink = nullptr;",
+    },
+    "find_if_v": {
+        "tuple": "static_assert(t::find_if_v<tuple_input, std::is_same, void> == N);",
+        "seq":   "static_assert(t::find_if_v<seq_input, std::is_same, t::seq_t<int, -1>> == N);",
+    },
+    "filter_t": {
+        "tuple": "using result = t::filter_t<tuple_input, is_even_tag>; result* sink = nullptr;",
+        "seq":   "using result = t::filter_t<seq_input, is_even_tag>; result* sink = nullptr;",
+    },
+    "reverse_t": {
+        "tuple": "using result = t::reverse_t<tuple_input>; result* sink = nullptr;",
+        "seq":   "using result = t::reverse_t<seq_input>; result* sink = nullptr;",
+    },
+    "concat_t": {
+        "tuple": "using result = concat_tuple_singles<std::make_index_sequence<N>>::type;"
+                 " result* sink = nullptr;",
+        "seq":   "using result = concat_seq_singles<std::make_index_sequence<N>>::type;"
+                 " result* sink = nullptr;",
+    },
+    "sorted_t": {
+        "seq":   "using result = t::sorted_t<seq_input>; result* sink = nullptr;",
+    },
+}
+
+BASELINE = "tuple_input* tuple_sink = nullptr; seq_input* seq_sink = nullptr;"
+
+
+def has_time_trace(cxx):
+    try:
+        r = subprocess.run([cxx, "-ftime-trace", "-fsyntax-only", "-x", "c++", "-"],
+                           input=b"", capture_output=True, timeout=60)
+        return r.returncode == 0
+    except (OSError, subprocess.TimeoutExpired):
+        return False
+
+
+def count_instantiations(trace_file):
+    try:
+        with open(trace_file) as f:
+            events = json.load(f).get("traceEvents", [])
+    except (OSError, ValueError):
+        return None
+    return sum(1 for e in events
+               if e.get("ph") == "X" and e.get("name", "").startswith("Instantiate"))
+
+
+def compile_once(cxx, flags, src, workdir, time_trace):
+    cmd = [cxx] + flags + ["-fsyntax-only", "-I", ROOT, src]
+    if time_trace:
+        cmd += ["-ftime-trace", "-ftime-trace-granularity=0"]
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, cwd=workdir, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    stderr = proc.stderr.read()
+    _, status, rusage = os.wait4(proc.pid, 0)
+    wall = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+
+    result = {"ok": proc.returncode == 0, "wall_s": round(wall, 4), "max_rss_kb": rusage.ru_maxrss}
+    if proc.returncode != 0:
+        lines = [l for l in stderr.decode(errors="replace").splitlines() if "error" in l]
+        result["error"] = lines[0] if lines else "exit code %d" % proc.returncode
+    result["instantiations"] = None
+    if time_trace:
+        result["instantiations"] = count_instantiations(os.path.splitext(src)[0] + ".json")
+    return result
+
+
+def measure(cxx, flags, body, n, workdir, name, repeat, time_trace):
+    src = os.path.join(workdir, name + ".cpp")
+    with open(src, "w") as f:
+        f.write(PRELUDE.replace("@N@", str(n)))
+        f.write(body + "\n")
+    runs = [compile_once(cxx, flags, src, workdir, time_trace) for _ in range(repeat)]
+    best = min(runs, key=lambda r: r["wall_s"])
+    best["max_rss_kb"] = max(r["max_rss_kb"] for r in runs)
+    return best
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("-o", "--output", default="type_util_bench.json")
+    ap.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    ap.add_argument("--std", default="c++17")
+    ap.add_argument("--flags", default="", help="extra compiler flags, space separated")
+    ap.add_argument("--sizes", default=",".join(map(str, DEFAULT_SIZES)))
+    ap.add_argument("--ops", default=",".join(OPS))
+    ap.add_argument("--repeat", type=int, default=1)
+    ap.add_argument("--max-wall", type=float, default=None,
+                    help="exit non-zero if any TU fails or takes longer, in seconds")
+    ap.add_argument("--keep", action="store_true", help="keep the generated sources")
+    args = ap.parse_args()
+
+    flags = ["-std=" + args.std] + args.flags.split()
+    sizes = [int(s) for s in args.sizes.split(",") if s]
+    ops = [o for o in args.ops.split(",") if o]
+    for op in ops:
+        if op not in OPS:
+            sys.exit("unknown op '%s', expected one of: %s" % (op, ", ".join(OPS)))
+
+    time_trace = has_time_trace(args.cxx)
+    workdir = tempfile.mkdtemp(prefix="type_util_bench_")
+    results = []
+    try:
+        for n in sizes:
+            base = measure(args.cxx, flags, BASELINE, n, workdir, "baseline_%d" % n,
+                           args.repeat, time_trace)
+            for op in ops:
+                for kind, body in OPS[op].items():
+                    r = measure(args.cxx, flags, body, n, workdir, "%s_%s_%d" % (op, kind, n),
+                                args.repeat, time_trace)
+                    r.update(op=op, kind=kind, n=n)
+                    if r["ok"] and base["ok"]:
+                        r["delta_wall_s"] = round(r["wall_s"] - base["wall_s"], 4)
+                        r["delta_max_rss_kb"] = r["max_rss_kb"] - base["max_rss_kb"]
+                        if r["instantiations"] is not None and base["instantiations"] is not None:
+                            r["delta_instantiations"] = r["instantiations"] - base["instantiations"]
+                    results.append(r)
+                    print("%-10s %-5s N=%-5d %s %8.3fs %8d KB%s" % (
+                        op, kind, n, "ok  " if r["ok"] else "FAIL", r["wall_s"], r["max_rss_kb"],
+                        "" if r["instantiations"] is None else " %d inst" % r["instantiations"]),
+                        file=sys.stderr)
+    finally:
+        if args.keep:
+            print("sources kept in " + workdir, file=sys.stderr)
+        else:
+            shutil.rmtree(workdir, ignore_errors=True)
+
+    with open(args.output, "w") as f:
+        json.dump({"compiler": args.cxx,
+                   "compiler_version": subprocess.run([args.cxx, "--version"], capture_output=True,
+                                                      text=True).stdout.splitlines()[0],
+                   "flags": flags,
+                   "time_trace": time_trace,
+                   "results": results}, f, indent=1)
+        f.write("\n")
+
+    if args.max_wall is not None:
+        slow = [r for r in results if not r["ok"] or r["wall_s"] > args.max_wall]
+        for r in slow:
+            print("over budget: %s %s N=%d %s" % (r["op"], r["kind"], r["n"],
+                  r.get("error", "%.3fs" % r["wall_s"])), file=sys.stderr)
+        if slow:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "type_util.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace t {
+namespace detail {
+
+inline constexpr size_t ring_line = 64;
+
+// Record of a message in a message_ring - a header, the message at its alignment,
+// rounded up to whole cache lines
+template <class Tag>
+struct ring_header {
+    uint32_t size;   // bytes of the record, a multiple of ring_line
+    Tag      tag;    // find_v index of the type, the type count for padding
+};
+
+template <class Tag, class T>
+struct ring_record {
+    static_assert(alignof(T) <= ring_line, "message_ring messages may be aligned to a cache line at most");
+    static constexpr size_t offset = (sizeof(ring_header<Tag>) + alignof(T) - 1) / alignof(T) * alignof(T);
+    static constexpr size_t size   = (offset + sizeof(T) + ring_line - 1) / ring_line * ring_line;
+};
+
+} // namespace detail
+
+// Single producer, single consumer ring of messages of the types of a tuple - each
+// one only as big as its own type, not the biggest, in whole cache lines. A record is
+// a small header with the type's index, then the message, constructed in place.
+// Records do not wrap: one that does not fit before the end of the ring is put at
+// the start, behind a padding record.
+//
+//     message_ring<std::tuple<order, cancel, fill>> ring;
+//     ring.push<order>(id, px, qty);                      // producer
+//     ring.consume([](auto& msg) { handle(msg); });       // consumer
+//
+// The indices are byte counts, each on its own cache line next to a cached copy of
+// the other side's, like spsc_queue. stage / publish and consume_all write their
+// index once for a batch of messages.
+// consume calls the visitor through a table of one function per type. A message is
+// destroyed after its visit, also when the visit throws.
+
+template <class List, size_t Bytes = (1 << 16)> class message_ring;
+
+template <class... Msgs, size_t Bytes>
+class message_ring<std::tuple<Msgs...>, Bytes> {
+    static_assert(sizeof...(Msgs) != 0, "message_ring needs at least one message type");
+    static_assert(Bytes >= detail::ring_line && (Bytes & (Bytes - 1)) == 0,
+                  "message_ring size must be a power of two bytes, at least a cache line");
+
+    using list_t = std::tuple<Msgs...>;
+
+public:
+    using tag_type = uint_for_t<sizeof...(Msgs)>;
+
+    static constexpr size_t capacity = Bytes;
+
+    // Bytes one message of T takes in the ring
+    template <class T>
+    static constexpr size_t record_size() {
+        static_assert(find_v<list_t, T> != sizeof...(Msgs), "message_ring: type is not in the list");
+        return detail::ring_record<tag_type, T>::size;
+    }
+
+    message_ring() : lines_(new line[Bytes / detail::ring_line]) {}
+
+    message_ring(const message_ring&)            = delete;
+    message_ring& operator=(const message_ring&) = delete;
+
+    ~message_ring() {
+        // Staged messages too
+        prod_.index.store(prod_.pending, std::memory_order_relaxed);
+        consume_all([](auto&) {});
+    }
+
+    // Producer side
+
+    // Construct a T at the end of the ring, not yet visible to the consumer - false
+    // if there is no room
+    template <class T, class... Args>
+    bool try_stage(Args&&... args) {
+        using record = detail::ring_record<tag_type, T>;
+        static_assert(record_size<T>() <= Bytes, "message_ring: message bigger than the ring");
+
+        size_t tail   = prod_.pending;
+        size_t pos    = tail % Bytes;
+        size_t to_end = Bytes - pos;
+        size_t need   = record::size <= to_end ? record::size : to_end + record::size;
+        if (Bytes - (tail - prod_.cached) < need) {
+            prod_.cached = cons_.index.load(std::memory_order_acquire);
+            if (Bytes - (tail - prod_.cached) < need) return false;
+        }
+        if (record::size > to_end) {
+            new (at(pos)) header{uint32_t(to_end), tag_type(sizeof...(Msgs))};
+            tail += to_end;
+            pos = 0;
+        }
+        new (at(pos) + record::offset) T(std::forward<Args>(args)...);
+        new (at(pos)) header{uint32_t(record::size), tag_type(find_v<list_t, T>)};
+        prod_.pending = tail + record::size;
+        return true;
+    }
+
+    // Waits for room
+    template <class T, class... Args>
+    void stage(Args&&... args) {
+        while (!try_stage<T>(std::forward<Args>(args)...)) std::this_thread::yield();
+    }
+
+    // Make the staged messages visible, one index store for all of them
+    void publish() { prod_.index.store(prod_.pending, std::memory_order_release); }
+
+    template <class T, class... Args>
+    bool try_push(Args&&... args) {
+        if (!try_stage<T>(std::forward<Args>(args)...)) return false;
+        publish();
+        return true;
+    }
+
+    template <class T, class... Args>
+    void push(Args&&... args) {
+        stage<T>(std::forward<Args>(args)...);
+        publish();
+    }
+
+    // Consumer side
+
+    // Visit and destroy the first message, false if there is none. The visitor takes
+    // each of the types as an lvalue, like [](auto& msg) { ... }.
+    template <class Visitor>
+    bool consume(Visitor&& visitor) {
+        return consume_all(visitor, 1) != 0;
+    }
+
+    // Visit and destroy up to max messages published so far - the consumer index is
+    // written once, after the last. Returns how many.
+    template <class Visitor>
+    size_t consume_all(Visitor&& visitor, size_t max = size_t(-1)) {
+        using visitor_t = std::remove_reference_t<Visitor>;
+        advance done{cons_, cons_.index.load(std::memory_order_relaxed)};
+        if (done.head == cons_.cached) {
+            cons_.cached = prod_.index.load(std::memory_order_acquire);
+        }
+        size_t count = 0;
+        while (count < max && done.head != cons_.cached) {
+            auto* h = std::launder(reinterpret_cast<header*>(at(done.head % Bytes)));
+            size_t size = h->size;
+            tag_type tag = h->tag;
+            done.head += size;
+            if (tag != sizeof...(Msgs)) {
+                visit_table<visitor_t>::table[tag](reinterpret_cast<std::byte*>(h), visitor);
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    // Bytes published and not yet consumed - exact on either side only when the
+    // other is idle
+    size_t size_bytes() const {
+        return prod_.index.load(std::memory_order_acquire) - cons_.index.load(std::memory_order_acquire);
+    }
+
+private:
+    using header = detail::ring_header<tag_type>;
+
+    struct alignas(detail::ring_line) line {
+        std::byte bytes[detail::ring_line];
+    };
+
+    // Own published index, the other side's last seen, and for the producer its
+    // staged end
+    struct alignas(detail::ring_line) side {
+        std::atomic<size_t> index{0};
+        size_t              cached  = 0;
+        size_t              pending = 0;
+    };
+
+    // Writes the consumer index on the way out, after a throwing visit too
+    struct advance {
+        side&  s;
+        size_t head;
+        ~advance() { s.index.store(head, std::memory_order_release); }
+    };
+
+    template <class T>
+    struct destroy_guard {
+        T* p;
+        ~destroy_guard() { p->~T(); }
+    };
+
+    template <class Visitor>
+    struct visit_table {
+        template <class T>
+        static void visit(std::byte* record, Visitor& v) {
+            T* p = std::launder(reinterpret_cast<T*>(record + detail::ring_record<tag_type, T>::offset));
+            destroy_guard<T> guard{p};
+            v(*p);
+        }
+
+        using entry_t = void (*)(std::byte*, Visitor&);
+        static constexpr entry_t table[sizeof...(Msgs)] = {&visit<Msgs>...};
+    };
+
+    std::byte* at(size_t pos) { return reinterpret_cast<std::byte*>(lines_.get()) + pos; }
+
+    side                    prod_;
+    side                    cons_;
+    std::unique_ptr<line[]> lines_;
+};
+
+}  // namespace t
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "type_util.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#if defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+
+namespace t {
+namespace detail {
+
+// Batcher's odd-even merge sort, for the next power of two, keeping only the
+// comparators inside N - the missing elements act as +infinity past the end.
+// Up to N = 8 this is also the smallest known network.
+// Pairs are flattened - lo0, hi0, lo1, hi1, ...
+
+template <size_t N>
+constexpr size_t batcher(size_t* out) {
+    size_t n = 1;
+    while (n < N) n *= 2;
+    size_t count = 0;
+    for (size_t p = 1; p < n; p *= 2) {
+        for (size_t k = p; k >= 1; k /= 2) {
+            for (size_t j = k % p; j + k < n; j += 2 * k) {
+                for (size_t i = 0; i < k && i + j + k < n; ++i) {
+                    size_t a = i + j, b = i + j + k;
+                    if (a / (2 * p) == b / (2 * p) && b < N) {
+                        if (out) {
+                            out[2 * count]     = a;
+                            out[2 * count + 1] = b;
+                        }
+                        ++count;
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+template <size_t N>
+struct sorting_network {
+    static constexpr size_t count = batcher<N>(nullptr);
+    static constexpr std::array<size_t, 2 * count> value = [] {
+        std::array<size_t, 2 * count> a{};
+        if constexpr (count != 0) batcher<N>(a.data());
+        return a;
+    }();
+    using type = typename array_seq<sorting_network, std::make_index_sequence<2 * count>>::type;
+};
+
+// Branchless compare-exchange - selects, which compile to cmov or min/max
+
+template <class T, class Compare>
+inline void compare_exchange(T& a, T& b, Compare comp) {
+    T x = a, y = b;
+    bool swap = comp(y, x);
+    a = swap ? y : x;
+    b = swap ? x : y;
+}
+
+// Expands a network, seq_t<size_t, lo0, hi0, ...>, into one compare_exchange per pair
+
+template <class Network> struct network_pairs;
+
+template <size_t... Ps>
+struct network_pairs<seq_t<size_t, Ps...>> {
+    static constexpr size_t p[] = {Ps..., 0};
+
+    template <class T, class Compare, size_t... Is>
+    static void apply([[maybe_unused]] T* data, [[maybe_unused]] Compare comp,
+                      std::index_sequence<Is...>) {
+        (compare_exchange(data[p[2 * Is]], data[p[2 * Is + 1]], comp), ...);
+    }
+
+    template <class T, class Compare>
+    static void apply(T* data, Compare comp) {
+        apply(data, comp, std::make_index_sequence<sizeof...(Ps) / 2>{});
+    }
+};
+
+// Vector min/max for network_sort_lanes, where there is an instruction for them
+
+template <class T>
+struct lane_ops {
+    static constexpr size_t width = 0;
+};
+
+#if defined(__AVX2__)
+template <>
+struct lane_ops<float> {
+    static constexpr size_t width = 8;
+    static void minmax(float* lo, float* hi) {
+        __m256 x = _mm256_loadu_ps(lo), y = _mm256_loadu_ps(hi);
+        _mm256_storeu_ps(lo, _mm256_min_ps(x, y));
+        _mm256_storeu_ps(hi, _mm256_max_ps(x, y));
+    }
+};
+
+template <>
+struct lane_ops<int32_t> {
+    static constexpr size_t width = 8;
+    static void minmax(int32_t* lo, int32_t* hi) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo), _mm256_min_epi32(x, y));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hi), _mm256_max_epi32(x, y));
+    }
+};
+#elif defined(__SSE2__)
+template <>
+struct lane_ops<float> {
+    static constexpr size_t width = 4;
+    static void minmax(float* lo, float* hi) {
+        __m128 x = _mm_loadu_ps(lo), y = _mm_loadu_ps(hi);
+        _mm_storeu_ps(lo, _mm_min_ps(x, y));
+        _mm_storeu_ps(hi, _mm_max_ps(x, y));
+    }
+};
+
+#  if defined(__SSE4_1__)
+template <>
+struct lane_ops<int32_t> {
+    static constexpr size_t width = 4;
+    static void minmax(int32_t* lo, int32_t* hi) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lo), _mm_min_epi32(x, y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(hi), _mm_max_epi32(x, y));
+    }
+};
+#  endif
+#endif
+
+} // namespace detail
+
+// Sorting network for N elements, as seq_t<size_t, lo0, hi0, lo1, hi1, ...> -
+// each pair is a compare-exchange that puts the smaller one at lo
+
+template <size_t N>
+using sorting_network_t = typename detail::sorting_network<N>::type;
+
+template <size_t N>
+inline constexpr size_t sorting_network_size_v = detail::sorting_network<N>::count;
+
+// Sort N elements with straight-line, branchless code - no loops, no data dependent
+// branches. Not stable.
+
+template <size_t N, class T, class Compare = std::less<>>
+inline void network_sort(T* data, Compare comp = {}) {
+    detail::network_pairs<sorting_network_t<N>>::apply(data, comp);
+}
+
+template <class T, size_t N, class Compare = std::less<>>
+inline void network_sort(std::array<T, N>& a, Compare comp = {}) {
+    network_sort<N>(a.data(), comp);
+}
+
+// Sort Lanes arrays of N elements at once, stored interleaved - element i of array l
+// is data[i * Lanes + l]. Every compare-exchange is a min and a max over Lanes
+// contiguous values - SSE or AVX2 min/max for float and int32_t when Lanes is a
+// multiple of the vector width (8, 16, 32 lanes), a scalar select otherwise.
+// NaNs are not ordered.
+
+template <size_t N, size_t Lanes, class T>
+inline void network_sort_lanes(T* data) {
+    using ops = detail::lane_ops<T>;
+    constexpr auto p = detail::sorting_network<N>::value;
+    for (size_t c = 0; c < p.size(); c += 2) {
+        T* lo = data + p[c] * Lanes;
+        T* hi = data + p[c + 1] * Lanes;
+        if constexpr (ops::width != 0 && Lanes % ops::width == 0) {
+            for (size_t l = 0; l < Lanes; l += ops::width) ops::minmax(lo + l, hi + l);
+        } else {
+            for (size_t l = 0; l < Lanes; ++l) detail::compare_exchange(lo[l], hi[l], std::less<>());
+        }
+    }
+}
+
+}  // namespace t
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "type_util.h"
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace t {
+namespace detail {
+
+// One member, tagged with its declaration index so get<I> is a single cast to a base
+
+template <size_t I, class T>
+struct packed_leaf {
+    constexpr packed_leaf() : value() {}
+
+    template <class A>
+    constexpr explicit packed_leaf(A&& a) : value(std::forward<A>(a)) {}
+
+    T value;
+};
+
+// Bases are laid out in the order they are listed - here decreasing alignment, so
+// every member lands on its alignment without padding in between.
+// Ps are the declaration indices in that order, Ss the types.
+
+template <class Perm, class Stored> struct packed_storage;
+
+template <size_t... Ps, class... Ss>
+struct packed_storage<seq_t<size_t, Ps...>, std::tuple<Ss...>> : packed_leaf<Ps, Ss>... {
+    constexpr packed_storage() = default;
+
+    template <class Args>
+    constexpr packed_storage(std::in_place_t, Args&& args)
+        : packed_leaf<Ps, Ss>(std::get<Ps>(std::move(args)))... {}
+};
+
+template <class... Ts>
+using packed_layout = sort_by<std::tuple<Ts...>, alignof_key, std::greater<>>;
+
+template <class... Ts>
+using packed_storage_t = packed_storage<typename packed_layout<Ts...>::permutation,
+                                        typename packed_layout<Ts...>::type>;
+
+} // namespace detail
+
+// Tuple that stores its members in decreasing alignment order, so there is no padding
+// between them, while get<I> still uses the declaration order.
+// permutation is seq_t<size_t, declaration index of each stored member>
+// slots is seq_t<size_t, storage slot of each declared member>
+
+template <class... Ts>
+class packed_tuple : detail::packed_storage_t<Ts...> {
+    using base_t = detail::packed_storage_t<Ts...>;
+
+    template <size_t I>
+    using leaf_t = detail::packed_leaf<I, select_t<int(I), std::tuple<Ts...>>>;
+
+public:
+    using tuple_type  = std::tuple<Ts...>;
+    using stored_type = typename detail::packed_layout<Ts...>::type;
+    using permutation = typename detail::packed_layout<Ts...>::permutation;
+    using slots       = typename detail::packed_layout<Ts...>::inverse;
+
+    // Size report, for static_assert
+
+    static constexpr size_t payload_bytes = (sizeof(Ts) + ... + 0);
+    static constexpr size_t tuple_bytes   = sizeof(tuple_type);
+    static constexpr size_t packed_bytes  = sizeof(base_t);
+    static constexpr ptrdiff_t bytes_saved = ptrdiff_t(tuple_bytes) - ptrdiff_t(packed_bytes);
+
+    constexpr packed_tuple() = default;
+
+    template <class... Args,
+              class = std::enable_if_t<sizeof...(Args) == sizeof...(Ts) && sizeof...(Ts) != 0
+                                       && (std::is_constructible_v<Ts, Args&&> && ...)>>
+    constexpr explicit packed_tuple(Args&&... args)
+        : base_t(std::in_place, std::forward_as_tuple(std::forward<Args>(args)...)) {}
+
+    template <size_t I>
+    constexpr auto& get() & {
+        return static_cast<leaf_t<I>&>(*this).value;
+    }
+
+    template <size_t I>
+    constexpr const auto& get() const & {
+        return static_cast<const leaf_t<I>&>(*this).value;
+    }
+
+    template <size_t I>
+    constexpr auto&& get() && {
+        return std::move(static_cast<leaf_t<I>&>(*this).value);
+    }
+
+    // Copy out in declaration order
+    constexpr tuple_type to_tuple() const {
+        return to_tuple(std::index_sequence_for<Ts...>{});
+    }
+
+private:
+    template <size_t... Is>
+    constexpr tuple_type to_tuple(std::index_sequence<Is...>) const {
+        return tuple_type(get<Is>()...);
+    }
+};
+
+template <size_t I, class... Ts>
+constexpr auto& get(packed_tuple<Ts...>& p) {
+    return p.template get<I>();
+}
+
+template <size_t I, class... Ts>
+constexpr const auto& get(const packed_tuple<Ts...>& p) {
+    return p.template get<I>();
+}
+
+template <size_t I, class... Ts>
+constexpr auto&& get(packed_tuple<Ts...>&& p) {
+    return std::move(p).template get<I>();
+}
+
+}  // namespace t
+
+// Structured bindings
+
+namespace std {
+
+template <class... Ts>
+struct tuple_size<t::packed_tuple<Ts...>> : integral_constant<size_t, sizeof...(Ts)> {};
+
+template <size_t I, class... Ts>
+struct tuple_element<I, t::packed_tuple<Ts...>> {
+    using type = t::select_t<int(I), tuple<Ts...>>;
+};
+
+}  // namespace std
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "type_util.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace t {
+namespace detail {
+
+// Perfect hash of the distinct integer constants of Seq, found at compile time -
+// hash, displace. A first multiplicative hash splits the constants into buckets of
+// about two. Biggest buckets first, each gets a seed that moves all of its constants
+// to free slots of a table at least twice their count:
+//     slot(x) = ((x ^ seed[bucket(x)]) * slot_mult) >> (64 - bits)
+// Two multiplies, one small table load and no branch. slot_index[s] is the position
+// in to_array_v<Seq> of the constant at slot s, n for none - a lookup compares x with
+// that constant, anything else is a miss.
+//
+// A primary template over the sequence type, so reading its arrays costs the same
+// for 10 constants or 10k.
+
+inline constexpr size_t   perfect_hash_seed_tries = 1 << 12;
+inline constexpr size_t   perfect_hash_mult_tries = 8;
+inline constexpr uint64_t perfect_hash_slot_mult  = 0x9e3779b97f4a7c15ull;
+
+template <class Seq>
+struct perfect_hash {
+    using value_type = typename Seq::value_type;
+    static_assert(std::is_integral_v<value_type>, "perfect_hash needs integer constants");
+    using unsigned_t = std::make_unsigned_t<value_type>;
+
+    static constexpr size_t n = size_v<Seq>;
+    static constexpr auto&  a = to_array_v<Seq>;
+
+    static constexpr unsigned log2_ceil(size_t x) {
+        unsigned b = 0;
+        while ((size_t(1) << b) < x) ++b;
+        return b;
+    }
+
+    static constexpr unsigned bits        = log2_ceil(2 * n) > 1 ? log2_ceil(2 * n) : 1;
+    static constexpr unsigned bucket_bits = bits > 2 ? bits - 2 : 1;
+    static constexpr size_t   slots       = size_t(1) << bits;
+    static constexpr size_t   buckets     = size_t(1) << bucket_bits;
+
+    static constexpr uint64_t as_u64(value_type x) { return uint64_t(unsigned_t(x)); }
+
+    static constexpr size_t bucket(value_type x, uint64_t mult) {
+        return size_t((as_u64(x) * mult) >> (64 - bucket_bits));
+    }
+
+    static constexpr size_t slot(value_type x, uint64_t seed) {
+        return size_t(((as_u64(x) ^ seed) * perfect_hash_slot_mult) >> (64 - bits));
+    }
+
+    struct table {
+        bool                                 found = false;
+        uint64_t                             mult  = 0;
+        std::array<uint64_t, buckets>        seed{};
+        std::array<uint_for_t<n>, slots>     slot_index{};
+    };
+
+    static constexpr table build() {
+        table tab;
+        uint64_t mult = 0x2545f4914f6cdd1dull;
+        for (size_t m = 0; m < perfect_hash_mult_tries && !tab.found; ++m) {
+            mult = (mult * 6364136223846793005ull + 1442695040888963407ull) | 1;
+            tab = try_build(mult);
+        }
+        return tab;
+    }
+
+    // Constants grouped by bucket, buckets placed biggest first
+    static constexpr table try_build(uint64_t mult) {
+        table tab;
+        tab.mult = mult;
+        for (auto& i : tab.slot_index) i = uint_for_t<n>(n);
+
+        size_t count[buckets + 1] = {};
+        for (size_t i = 0; i < n; ++i) ++count[bucket(a[i], mult) + 1];
+        size_t start[buckets + 1] = {};
+        for (size_t b = 0; b < buckets; ++b) start[b + 1] = start[b] + count[b + 1];
+        size_t member[n + 1] = {};
+        size_t fill[buckets + 1] = {};
+        for (size_t i = 0; i < n; ++i) {
+            size_t b = bucket(a[i], mult);
+            member[start[b] + fill[b]++] = i;
+        }
+
+        size_t biggest = 0;
+        for (size_t b = 0; b < buckets; ++b) biggest = count[b + 1] > biggest ? count[b + 1] : biggest;
+
+        size_t placed[n + 1] = {};
+        for (size_t size = biggest; size > 0; --size) {
+            for (size_t b = 0; b < buckets; ++b) {
+                if (count[b + 1] != size) continue;
+                bool ok = false;
+                for (uint64_t s = 1; s <= perfect_hash_seed_tries && !ok; ++s) {
+                    const uint64_t seed = s * 0xbf58476d1ce4e5b9ull;
+                    size_t k = 0;
+                    for (; k < size; ++k) {
+                        size_t sl = slot(a[member[start[b] + k]], seed);
+                        if (tab.slot_index[sl] != n) break;
+                        tab.slot_index[sl] = uint_for_t<n>(member[start[b] + k]);
+                        placed[k] = sl;
+                    }
+                    ok = k == size;
+                    // Undo a partial placement
+                    if (!ok) {
+                        for (size_t u = 0; u < k; ++u) tab.slot_index[placed[u]] = uint_for_t<n>(n);
+                    } else {
+                        tab.seed[b] = seed;
+                    }
+                }
+                if (!ok) return table{};
+            }
+        }
+        tab.found = true;
+        return tab;
+    }
+
+    static constexpr table value = build();
+
+    static constexpr size_t slot_of(value_type x) {
+        return slot(x, value.seed[bucket(x, value.mult)]);
+    }
+
+    // Constant at each slot - empty slots hold one that hashes elsewhere, so comparing
+    // with it fails there too
+    static constexpr std::array<value_type, slots> keys = [] {
+        std::array<value_type, slots> k{};
+        for (size_t s = 0; s < slots; ++s) {
+            k[s] = n == 0 ? value_type() : a[value.slot_index[s] != n ? value.slot_index[s] : 0];
+        }
+        return k;
+    }();
+};
+
+// One multiply, no seed table - slot(x) = (x * mult) >> (64 - bits). Without a
+// second level only a sparse table is free of collisions, so this searches tables of
+// 2 to 64 times the count of constants, up to 2^16 slots - a few hundred constants.
+// found is false past that, or when no multiplier fits.
+
+inline constexpr size_t   multiply_shift_tries    = 512;
+inline constexpr unsigned multiply_shift_max_bits = 16;
+
+template <class Seq>
+struct multiply_shift_hash {
+    using value_type = typename Seq::value_type;
+    static_assert(std::is_integral_v<value_type>, "multiply_shift_hash needs integer constants");
+    using unsigned_t = std::make_unsigned_t<value_type>;
+
+    static constexpr size_t n = size_v<Seq>;
+    static constexpr auto&  a = to_array_v<Seq>;
+
+    static constexpr unsigned min_bits = perfect_hash<Seq>::log2_ceil(2 * n) > 1
+                                         ? perfect_hash<Seq>::log2_ceil(2 * n) : 1;
+
+    struct params {
+        bool     found = false;
+        uint64_t mult  = 0;
+        unsigned bits  = 1;
+    };
+
+    // Slots stamped with the try that last used them, so no clearing between tries.
+    // A failing try stops at its first collision, after about sqrt(slots) constants.
+    static constexpr params value = [] {
+        params p;
+        if (min_bits > multiply_shift_max_bits) return p;
+        uint16_t stamp[size_t(1) << multiply_shift_max_bits] = {};
+        uint16_t tries = 0;
+        uint64_t mult  = 0x9e3779b97f4a7c15ull;
+        for (unsigned bits = min_bits; bits <= min_bits + 5 && bits <= multiply_shift_max_bits; ++bits) {
+            for (size_t t = 0; t < multiply_shift_tries; ++t) {
+                mult = (mult * 6364136223846793005ull + 1442695040888963407ull) | 1;
+                ++tries;
+                size_t i = 0;
+                for (; i < n; ++i) {
+                    size_t s = size_t((uint64_t(unsigned_t(a[i])) * mult) >> (64 - bits));
+                    if (stamp[s] == tries) break;
+                    stamp[s] = tries;
+                }
+                if (i == n) return params{true, mult, bits};
+            }
+        }
+        return p;
+    }();
+
+    static constexpr size_t slots = size_t(1) << value.bits;
+
+    static constexpr size_t slot_of(value_type x) {
+        return size_t((uint64_t(unsigned_t(x)) * value.mult) >> (64 - value.bits));
+    }
+};
+
+// Hash::value.found as a trait, so std::conjunction and std::disjunction only build
+// the hashes they need
+template <class Hash>
+struct hash_found : std::bool_constant<Hash::value.found> {};
+
+} // namespace detail
+}  // namespace t
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "type_util.h"
+#include "spsc_queue.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace t {
+
+// Default capacity of the queue in front of a blocking stage
+inline constexpr size_t pipeline_queue_capacity = 1024;
+
+namespace detail {
+
+// A stage is a class with
+//     using input_type  = ...;
+//     using output_type = ...;
+//     output_type operator()(input_type);
+// and optionally
+//     static constexpr bool   blocking       = true;   // I/O, locks, slow calls
+//     static constexpr size_t queue_capacity = N;      // of its input queue
+
+template <class S>
+struct stage_input {
+    using type = typename S::input_type;
+};
+
+template <class S>
+struct stage_output {
+    using type = typename S::output_type;
+};
+
+template <class S, class = void>
+struct stage_blocking {
+    static constexpr bool value = false;
+};
+
+template <class S>
+struct stage_blocking<S, std::void_t<decltype(S::blocking)>> {
+    static constexpr bool value = S::blocking;
+};
+
+template <class S, class = void>
+struct stage_capacity {
+    static constexpr size_t value = pipeline_queue_capacity;
+};
+
+template <class S>
+struct stage_capacity<S, std::void_t<decltype(S::queue_capacity)>> {
+    static constexpr size_t value = S::queue_capacity;
+};
+
+// Instantiated for the first pair of adjacent stages that do not match - the stage
+// index and both types are in the "required from" note
+template <size_t I, class Output, class NextInput>
+struct pipeline_stage_mismatch {
+    static_assert(std::is_same_v<Output, NextInput>,
+                  "pipeline: output_type of stage I is not the input_type of stage I + 1");
+    static constexpr bool value = true;
+};
+
+template <class Pair, class>
+struct link_differs;
+
+template <class Output, class NextInput, class Ignored>
+struct link_differs<std::tuple<Output, NextInput>, Ignored> {
+    static constexpr bool value = !std::is_same_v<Output, NextInput>;
+};
+
+template <class Stages>
+struct pipeline_links {
+    using inputs  = transform_t<Stages, stage_input>;
+    using outputs = transform_t<Stages, stage_output>;
+    static constexpr size_t n = size_v<Stages>;
+
+    // (output i, input i + 1) for every adjacent pair
+    using links = zip_t<head_t<int(n) - 1, outputs>, skip_t<1, inputs>>;
+    static constexpr size_t first_bad = find_if_v<links, link_differs>;
+
+    static constexpr bool check() {
+        if constexpr (first_bad != size_v<links>) {
+            using bad = select_t<int(first_bad), links>;
+            return pipeline_stage_mismatch<first_bad, select_t<0, bad>, select_t<1, bad>>::value;
+        } else {
+            return true;
+        }
+    }
+};
+
+// Segments - runs of stages fused into one call per element. A blocking stage starts
+// a new segment, which runs on its own thread behind a queue. Segment k is stages
+// [bounds[k], bounds[k + 1]); segment 0 runs on the caller and may be empty.
+
+template <class Stages>
+struct pipeline_segments {
+    static constexpr size_t n = size_v<Stages>;
+
+    // Segment of each stage - count of blocking stages up to and including it
+    using segment_of = inclusive_scan_t<keys_t<Stages, stage_blocking>>;
+    static constexpr size_t count = n == 0 ? 1 : size_t(select_v<int(n) - 1, segment_of>) + 1;
+
+    static constexpr std::array<size_t, count + 1> bounds = [] {
+        std::array<size_t, count + 1> b{};
+        const auto& seg = to_array_v<segment_of>;
+        for (size_t k = 1; k <= count; ++k) {
+            size_t i = 0;
+            while (i < n && size_t(seg[i]) < k) ++i;
+            b[k] = i;
+        }
+        return b;
+    }();
+};
+
+} // namespace detail
+
+// A chain of stages, each one's output_type the next one's input_type - checked at
+// compile time. Runs of non-blocking stages are fused into one inlined call per
+// element, with no buffer between them. Each blocking stage gets an spsc_queue in
+// front of it and a worker thread for its segment, so only blocking stages pay for a
+// hand-off.
+//
+//     pipeline<parse, validate, enrich, store> p;    // store::blocking = true
+//     p.run(lines.begin(), lines.end(), std::back_inserter(results));
+//
+// Without blocking stages the whole pipeline is also one function, p(x).
+// A stage belongs to one segment, so it is only ever called from one thread.
+// An exception from a stage stops the run - no more input is read, and elements
+// already queued are dropped - and is rethrown by run() once the workers are joined.
+
+template <class... Stages>
+class pipeline {
+    static_assert(sizeof...(Stages) != 0, "pipeline needs at least one stage");
+
+    using list_t   = std::tuple<Stages...>;
+    using links    = detail::pipeline_links<list_t>;
+    using segments = detail::pipeline_segments<list_t>;
+    static_assert(links::check());
+
+public:
+    using input_type  = typename select_t<0, list_t>::input_type;
+    using output_type = typename select_t<int(sizeof...(Stages)) - 1, list_t>::output_type;
+
+    // Number of segments, and the segment of each stage
+    static constexpr size_t segment_count = segments::count;
+    using segment_of = typename segments::segment_of;
+
+    pipeline() = default;
+    explicit pipeline(Stages... stages) : stages_(std::move(stages)...) {}
+
+    template <size_t I>
+    auto& stage() { return std::get<I>(stages_); }
+
+    // All stages on the caller's thread - only without blocking stages
+    output_type operator()(input_type x) {
+        static_assert(segment_count == 1, "pipeline with blocking stages - use run()");
+        return run_segment<0>(std::move(x));
+    }
+
+    // Push [first, last) through, outputs to out in input order. Returns the end of
+    // the output.
+    template <class It, class Out>
+    Out run(It first, It last, Out out) {
+        if constexpr (segment_count == 1) {
+            for (; first != last; ++first) *out++ = run_segment<0>(input_type(*first));
+            return out;
+        } else {
+            return run_threads(first, last, out, std::make_index_sequence<segment_count - 1>{});
+        }
+    }
+
+private:
+    std::tuple<Stages...> stages_;
+
+    // Stages [I, E) of x, nested calls the compiler inlines into one
+    template <size_t I, size_t E, class X>
+    auto apply(X&& x) {
+        if constexpr (I == E) {
+            return std::decay_t<X>(std::forward<X>(x));
+        } else {
+            return apply<I + 1, E>(std::get<I>(stages_)(std::forward<X>(x)));
+        }
+    }
+
+    template <size_t K>
+    static constexpr size_t begin_of = segments::bounds[K];
+
+    template <size_t K>
+    static constexpr size_t end_of = segments::bounds[K + 1];
+
+    // Input of segment K, of its first stage - an empty segment 0 starts at stage 0 too
+    template <size_t K>
+    using segment_input = typename select_t<int(begin_of<K>), list_t>::input_type;
+
+    template <size_t K>
+    auto run_segment(segment_input<K> x) {
+        return apply<begin_of<K>, end_of<K>>(std::move(x));
+    }
+
+    // Queue in front of segment K, K >= 1 - its first stage is the blocking one
+    template <size_t K>
+    using queue_t = spsc_queue<segment_input<K>,
+                               detail::stage_capacity<select_t<int(begin_of<K>), list_t>>::value>;
+
+    template <class Queues, size_t K, class Out>
+    void worker(Queues& queues, Out& out, std::exception_ptr& error, std::atomic<bool>& stop) {
+        auto& in = *std::get<K - 1>(queues);
+        std::optional<segment_input<K>> x;    // stage inputs need not be default constructible
+        while (in.pop(x)) {
+            // After a failure keep draining, so the producer never waits on a full queue
+            if (stop.load(std::memory_order_relaxed)) continue;
+            try {
+                if constexpr (K + 1 == segment_count) {
+                    *out++ = run_segment<K>(std::move(*x));
+                } else {
+                    std::get<K>(queues)->push(run_segment<K>(std::move(*x)));
+                }
+            } catch (...) {
+                error = std::current_exception();
+                stop.store(true, std::memory_order_relaxed);
+            }
+        }
+        if constexpr (K + 1 != segment_count) std::get<K>(queues)->close();
+    }
+
+    template <class It, class Out, size_t... Ks>
+    Out run_threads(It first, It last, Out out, std::index_sequence<Ks...>) {
+        auto queues = std::make_tuple(std::make_unique<queue_t<Ks + 1>>()...);
+        std::exception_ptr errors[sizeof...(Ks) + 1];
+        std::atomic<bool>  stop{false};
+        std::thread workers[] = {
+            std::thread([&] { worker<decltype(queues), Ks + 1, Out>(queues, out, errors[Ks + 1], stop); })...
+        };
+        auto& head = *std::get<0>(queues);
+        try {
+            for (; first != last && !stop.load(std::memory_order_relaxed); ++first) {
+                head.push(run_segment<0>(input_type(*first)));
+            }
+        } catch (...) {
+            errors[0] = std::current_exception();
+        }
+        head.close();
+        for (auto& w : workers) w.join();
+        for (auto& e : errors) {
+            if (e) std::rethrow_exception(e);
+        }
+        return out;
+    }
+};
+
+}  // namespace t
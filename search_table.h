@@ -0,0 +1,111 @@
+#pragma once
+
+#include "type_util.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace t {
+namespace detail {
+
+// Sorted position of each slot - an in-order walk of the implicit tree, without
+// recursion
+template <size_t N>
+constexpr void eytzinger_order(std::array<size_t, N + 1>& ix) {
+    if (N == 0) return;
+    size_t k = 1;
+    while (2 * k <= N) k = 2 * k;
+    for (size_t i = 0; k != 0; ++i) {
+        ix[k] = i;
+        if (2 * k + 1 <= N) {
+            // Leftmost of the right subtree
+            k = 2 * k + 1;
+            while (2 * k <= N) k = 2 * k;
+        } else {
+            // Up past right children, then to the parent
+            while (k & 1) k >>= 1;
+            k >>= 1;
+        }
+    }
+}
+
+} // namespace detail
+
+// Sorted sequence constants in Eytzinger order - the implicit binary tree of a binary
+// search stored breadth first, root at [1], children of k at 2k and 2k + 1. Every
+// step of a search reads one slot further down the same few cache lines, and the
+// step is a compare and an add, not a branch. The slots 4 levels down are one cache
+// line, fetched while the 4 levels above are compared.
+//
+//     using tiers = seq_t<int, 0, 1000, 10000, 100000, 1000000>;
+//     size_t tier = search_table<tiers>::rank(volume) ...
+//
+// lower_bound / upper_bound point into to_array_v<Seq>, the sorted constants, like
+// std::lower_bound / std::upper_bound on them. rank(x) is lower_bound(x)'s index,
+// the number of constants less than x.
+
+template <class Seq>
+struct search_table {
+    using value_type = typename Seq::value_type;
+
+    static constexpr size_t n = size_v<Seq>;
+    static constexpr auto&  sorted = to_array_v<Seq>;
+
+    static_assert([] {
+        for (size_t i = 1; i < n; ++i) {
+            if (sorted[i] < sorted[i - 1]) return false;
+        }
+        return true;
+    }(), "search_table needs a sorted sequence - see sorted_t");
+
+    // Slots per cache line - the prefetch distance is 4 levels when it is 16
+    static constexpr size_t line = 64 / sizeof(value_type) ? 64 / sizeof(value_type) : 1;
+
+    // layout[k] is the constant at slot k, index[k] its position in sorted. Slot 0 is
+    // where a search past the last constant ends, so index[0] = n.
+    alignas(64) static constexpr std::array<value_type, n + 1> layout = [] {
+        std::array<value_type, n + 1> b{};
+        std::array<size_t, n + 1> ix{};
+        detail::eytzinger_order<n>(ix);
+        for (size_t k = 1; k <= n; ++k) b[k] = sorted[ix[k]];
+        return b;
+    }();
+
+    static constexpr std::array<uint_for_t<n>, n + 1> index = [] {
+        std::array<size_t, n + 1> ix{};
+        detail::eytzinger_order<n>(ix);
+        std::array<uint_for_t<n>, n + 1> r{};
+        r[0] = uint_for_t<n>(n);
+        for (size_t k = 1; k <= n; ++k) r[k] = uint_for_t<n>(ix[k]);
+        return r;
+    }();
+
+    static size_t rank(value_type x) { return index[descend<false>(x)]; }
+
+    static const value_type* lower_bound(value_type x) {
+        return sorted.data() + index[descend<false>(x)];
+    }
+
+    static const value_type* upper_bound(value_type x) {
+        return sorted.data() + index[descend<true>(x)];
+    }
+
+private:
+    // Slot of the first constant >= x (Upper: > x), 0 if there is none. The path
+    // ends past a leaf - its turns to the right are trailing ones, and the answer is
+    // where the last left turn was taken.
+    template <bool Upper>
+    static size_t descend(value_type x) {
+        size_t k = 1;
+        while (k <= n) {
+            // An address, never dereferenced - past the end is fine
+            __builtin_prefetch(reinterpret_cast<const void*>(
+                reinterpret_cast<uintptr_t>(layout.data()) + k * line * sizeof(value_type)));
+            if constexpr (Upper) k = 2 * k + !(x < layout[k]);
+            else                 k = 2 * k + (layout[k] < x);
+        }
+        return k >> (__builtin_ctzll(~uint64_t(k)) + 1);
+    }
+};
+
+}  // namespace t
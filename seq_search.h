@@ -0,0 +1,234 @@
+#pragma once
+
+#include "type_util.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+
+namespace t {
+
+// How contains / index_of search a sequence at runtime
+//  unrolled - one compare per element, for a handful of them
+//  bitmap   - one bit test (contains) or one table load (index_of) when the values
+//             span a small range
+//  simd     - compares against the whole array, padded to full vectors, SSE2 or AVX2
+//  scalar   - a plain loop
+
+enum class seq_search_kind { unrolled, bitmap, simd, scalar };
+
+namespace detail {
+
+inline constexpr size_t seq_search_unrolled_max = 8;
+inline constexpr size_t seq_search_bitmap_range = 1024;
+
+#if defined(__AVX2__)
+inline constexpr size_t simd_bytes = 32;
+#elif defined(__SSE2__)
+inline constexpr size_t simd_bytes = 16;
+#else
+inline constexpr size_t simd_bytes = 0;
+#endif
+
+// 64 bit lanes need SSE4.1 or AVX2 to compare
+template <class T>
+inline constexpr bool simd_searchable = simd_bytes != 0
+#if !defined(__SSE4_1__) && !defined(__AVX2__)
+                                        && sizeof(T) != 8
+#endif
+                                        ;
+
+#if defined(__SSE2__)
+#  if defined(__AVX2__)
+using simd_reg = __m256i;
+
+inline simd_reg simd_load(const void* p) { return _mm256_load_si256(static_cast<const simd_reg*>(p)); }
+inline simd_reg simd_or(simd_reg a, simd_reg b) { return _mm256_or_si256(a, b); }
+inline uint32_t simd_mask(simd_reg a) { return uint32_t(_mm256_movemask_epi8(a)); }
+
+template <class T>
+inline simd_reg simd_splat(T x) {
+    if constexpr (sizeof(T) == 1) return _mm256_set1_epi8(char(x));
+    if constexpr (sizeof(T) == 2) return _mm256_set1_epi16(short(x));
+    if constexpr (sizeof(T) == 4) return _mm256_set1_epi32(int(x));
+    if constexpr (sizeof(T) == 8) return _mm256_set1_epi64x((long long)(x));
+}
+
+template <class T>
+inline simd_reg simd_eq(simd_reg a, simd_reg b) {
+    if constexpr (sizeof(T) == 1) return _mm256_cmpeq_epi8(a, b);
+    if constexpr (sizeof(T) == 2) return _mm256_cmpeq_epi16(a, b);
+    if constexpr (sizeof(T) == 4) return _mm256_cmpeq_epi32(a, b);
+    if constexpr (sizeof(T) == 8) return _mm256_cmpeq_epi64(a, b);
+}
+#  else
+using simd_reg = __m128i;
+
+inline simd_reg simd_load(const void* p) { return _mm_load_si128(static_cast<const simd_reg*>(p)); }
+inline simd_reg simd_or(simd_reg a, simd_reg b) { return _mm_or_si128(a, b); }
+inline uint32_t simd_mask(simd_reg a) { return uint32_t(_mm_movemask_epi8(a)); }
+
+template <class T>
+inline simd_reg simd_splat(T x) {
+    if constexpr (sizeof(T) == 1) return _mm_set1_epi8(char(x));
+    if constexpr (sizeof(T) == 2) return _mm_set1_epi16(short(x));
+    if constexpr (sizeof(T) == 4) return _mm_set1_epi32(int(x));
+    if constexpr (sizeof(T) == 8) return _mm_set1_epi64x((long long)(x));
+}
+
+template <class T>
+inline simd_reg simd_eq(simd_reg a, simd_reg b) {
+    if constexpr (sizeof(T) == 1) return _mm_cmpeq_epi8(a, b);
+    if constexpr (sizeof(T) == 2) return _mm_cmpeq_epi16(a, b);
+    if constexpr (sizeof(T) == 4) return _mm_cmpeq_epi32(a, b);
+#    if defined(__SSE4_1__)
+    if constexpr (sizeof(T) == 8) return _mm_cmpeq_epi64(a, b);
+#    endif
+}
+#  endif
+#endif
+
+template <class Seq> struct seq_search;
+
+template <class T, T... Is>
+struct seq_search<seq_t<T, Is...>> {
+    using value_type = T;
+    using unsigned_t = std::make_unsigned_t<T>;
+
+    static constexpr size_t n = sizeof...(Is);
+    static constexpr auto&  a = to_array_v<seq_t<T, Is...>>;
+
+    static constexpr T lo = n ? *std::min_element(a.begin(), a.end()) : T();
+    static constexpr T hi = n ? *std::max_element(a.begin(), a.end()) : T();
+
+    // hi - lo, without overflow for signed T - the outer cast undoes the promotion
+    // of char and short to int
+    static constexpr uint64_t span = uint64_t(unsigned_t(unsigned_t(hi) - unsigned_t(lo)));
+
+    static constexpr seq_search_kind best =
+        n <= seq_search_unrolled_max        ? seq_search_kind::unrolled :
+        span < seq_search_bitmap_range      ? seq_search_kind::bitmap   :
+        simd_searchable<T>                  ? seq_search_kind::simd     :
+                                              seq_search_kind::scalar;
+
+    // bitmap
+
+    static constexpr size_t range = n ? size_t(std::min<uint64_t>(span, seq_search_bitmap_range)) + 1 : 0;
+
+    static constexpr bool in_range(T x) {
+        return uint64_t(unsigned_t(unsigned_t(x) - unsigned_t(lo))) < range;
+    }
+
+    static constexpr std::array<uint64_t, (range + 63) / 64> bits = [] {
+        std::array<uint64_t, (range + 63) / 64> b{};
+        if (span < seq_search_bitmap_range) {
+            for (T v : a) {
+                size_t k = size_t(unsigned_t(unsigned_t(v) - unsigned_t(lo)));
+                b[k / 64] |= uint64_t(1) << (k % 64);
+            }
+        }
+        return b;
+    }();
+
+    // Index of the first occurrence of each value in the range, n where there is none
+    static constexpr std::array<uint_for_t<n>, range> positions = [] {
+        std::array<uint_for_t<n>, range> p{};
+        if (span < seq_search_bitmap_range) {
+            for (auto& v : p) v = uint_for_t<n>(n);
+            for (size_t i = n; i-- > 0; ) {
+                p[size_t(unsigned_t(unsigned_t(a[i]) - unsigned_t(lo)))] = uint_for_t<n>(i);
+            }
+        }
+        return p;
+    }();
+
+    // simd - padded with copies of a[0], which can never be the first match past n
+
+    static constexpr size_t lanes    = simd_bytes ? simd_bytes / sizeof(T) : 1;
+    static constexpr size_t padded_n = n ? (n + lanes - 1) / lanes * lanes : lanes;
+
+    alignas(simd_bytes ? simd_bytes : alignof(T))
+    static constexpr std::array<T, padded_n> padded = [] {
+        std::array<T, padded_n> p{};
+        for (size_t i = 0; i < padded_n; ++i) p[i] = n ? a[i < n ? i : 0] : T();
+        return p;
+    }();
+
+    template <seq_search_kind Kind>
+    static bool contains(T x) {
+        if constexpr (Kind == seq_search_kind::unrolled) {
+            return ((x == Is) || ...);
+        } else if constexpr (Kind == seq_search_kind::bitmap) {
+            static_assert(span < seq_search_bitmap_range, "values span too wide for a bitmap");
+            size_t k = size_t(unsigned_t(unsigned_t(x) - unsigned_t(lo)));
+            return in_range(x) && (bits[k / 64] >> (k % 64) & 1);
+        } else if constexpr (Kind == seq_search_kind::simd && simd_searchable<T>) {
+#if defined(__SSE2__)
+            if constexpr (n == 0) return false;
+            const simd_reg needle = simd_splat(x);
+            simd_reg hits = simd_eq<T>(simd_load(padded.data()), needle);
+            for (size_t i = lanes; i < padded_n; i += lanes) {
+                hits = simd_or(hits, simd_eq<T>(simd_load(padded.data() + i), needle));
+            }
+            return simd_mask(hits) != 0;
+#endif
+        } else {
+            return index_of<seq_search_kind::scalar>(x) != n;
+        }
+    }
+
+    template <seq_search_kind Kind>
+    static size_t index_of(T x) {
+        if constexpr (Kind == seq_search_kind::unrolled) {
+            size_t i = 0;
+            ((x == Is ? true : (++i, false)) || ...);
+            return i;
+        } else if constexpr (Kind == seq_search_kind::bitmap) {
+            static_assert(span < seq_search_bitmap_range, "values span too wide for a bitmap");
+            return in_range(x) ? positions[size_t(unsigned_t(unsigned_t(x) - unsigned_t(lo)))] : n;
+        } else if constexpr (Kind == seq_search_kind::simd && simd_searchable<T>) {
+#if defined(__SSE2__)
+            if constexpr (n == 0) return n;
+            const simd_reg needle = simd_splat(x);
+            for (size_t i = 0; i < padded_n; i += lanes) {
+                uint32_t m = simd_mask(simd_eq<T>(simd_load(padded.data() + i), needle));
+                if (m) return i + size_t(__builtin_ctz(m)) / sizeof(T);
+            }
+            return n;
+#endif
+        } else {
+            size_t i = 0;
+            while (i < n && a[i] != x) ++i;
+            return i;
+        }
+    }
+};
+
+} // namespace detail
+
+// The search chosen for a sequence, from its size and value range
+
+template <class Seq>
+inline constexpr seq_search_kind seq_search_v = detail::seq_search<Seq>::best;
+
+// Runtime search of a sequence's constants - is x in it, and the index of its first
+// occurrence, or end_v<Seq> if there is none.
+// Kind overrides the choice, mostly for testing and benchmarks. simd falls back to
+// scalar where it is not available.
+
+template <class Seq, seq_search_kind Kind = seq_search_v<Seq>>
+inline bool contains(typename Seq::value_type x) {
+    return detail::seq_search<Seq>::template contains<Kind>(x);
+}
+
+template <class Seq, seq_search_kind Kind = seq_search_v<Seq>>
+inline size_t index_of(typename Seq::value_type x) {
+    return detail::seq_search<Seq>::template index_of<Kind>(x);
+}
+
+}  // namespace t
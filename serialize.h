@@ -0,0 +1,280 @@
+#pragma once
+
+#include "type_util.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace t {
+
+// Wire format of a tuple - its fields in order, without padding, in native byte order.
+// Trivially copyable fields are their bytes. Other fields go through wire_codec<T>:
+//     static size_t           size(const T&);
+//     static std::byte*       write(std::byte* out, const T&);            // past the end
+//     static const std::byte* read(const std::byte* in, const std::byte* end, T&);
+//                                                     // past the end, nullptr if short
+
+template <class T, class = void>
+struct wire_codec;
+
+// Strings - uint32_t length, then the characters
+template <class C, class Traits, class Alloc>
+struct wire_codec<std::basic_string<C, Traits, Alloc>> {
+    using string_t = std::basic_string<C, Traits, Alloc>;
+
+    static size_t size(const string_t& s) { return sizeof(uint32_t) + s.size() * sizeof(C); }
+
+    static std::byte* write(std::byte* out, const string_t& s) {
+        uint32_t n = uint32_t(s.size());
+        std::memcpy(out, &n, sizeof(n));
+        std::memcpy(out + sizeof(n), s.data(), n * sizeof(C));
+        return out + sizeof(n) + n * sizeof(C);
+    }
+
+    static const std::byte* read(const std::byte* in, const std::byte* end, string_t& s) {
+        uint32_t n;
+        if (size_t(end - in) < sizeof(n)) return nullptr;
+        std::memcpy(&n, in, sizeof(n));
+        in += sizeof(n);
+        if (size_t(end - in) / sizeof(C) < n) return nullptr;
+        s.resize(n);
+        std::memcpy(s.data(), in, n * sizeof(C));
+        return in + n * sizeof(C);
+    }
+};
+
+// Field predicates, in the shape of filter_t's
+
+template <class T, class = void>
+struct is_wire_fixed {
+    static constexpr bool value = std::is_trivially_copyable_v<T>;
+};
+
+template <class T, class = void>
+struct is_wire_variable {
+    static constexpr bool value = !std::is_trivially_copyable_v<T>;
+};
+
+namespace detail {
+
+// Runs of adjacent fixed fields - each run is one bounds check and one block of
+// constant size copies at constant offsets. Per field i:
+//   offset - from the start of its run
+//   run    - bytes of the run, at the field that starts it, 0 elsewhere
+//   last   - whether it ends its run
+
+template <class Tuple>
+struct wire_layout {
+    static constexpr size_t n = size_v<Tuple>;
+    using fixed = keys_t<Tuple, is_wire_fixed>;
+    using sizes = keys_t<Tuple, sizeof_key>;
+
+    struct field {
+        size_t offset = 0;
+        size_t run    = 0;
+        bool   last   = false;
+    };
+
+    static constexpr std::array<field, n> fields = [] {
+        const auto& f = to_array_v<fixed>;
+        const auto& s = to_array_v<sizes>;
+        std::array<field, n> a{};
+        size_t start = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (!f[i]) continue;
+            if (i == 0 || !f[i - 1]) start = i;
+            a[i].offset = i == start ? 0 : a[i - 1].offset + s[i - 1];
+            a[i].last   = i + 1 == n || !f[i + 1];
+            if (a[i].last) a[start].run = a[i].offset + s[i];
+        }
+        return a;
+    }();
+
+    // Bytes of all fixed fields
+    static constexpr size_t fixed_bytes = [] {
+        size_t b = 0;
+        for (const field& x : fields) b += x.run;
+        return b;
+    }();
+};
+
+template <class T>
+inline size_t wire_size(const T& v) {
+    if constexpr (is_wire_fixed<T>::value) return sizeof(T);
+    else                                   return wire_codec<T>::size(v);
+}
+
+} // namespace detail
+
+// Serialize a tuple to its wire format and back
+//
+//     std::vector<std::byte> buf(serialize<Msg>::size(msg));
+//     serialize<Msg>::write(buf.data(), msg);
+//     serialize<Msg>::read(buf.data(), buf.data() + buf.size(), msg);
+//
+// fixed_fields / variable_fields split the fields by how they are copied.
+// std::tuple does not specify where its members are, so a run cannot be one memcpy
+// from the tuple - it is one check and a memcpy per field at constant offsets, which
+// the compiler turns into plain loads and stores.
+
+template <class Tuple>
+struct serialize {
+    using layout          = detail::wire_layout<Tuple>;
+    using fixed_fields    = filter_t<Tuple, is_wire_fixed>;
+    using variable_fields = filter_t<Tuple, is_wire_variable>;
+
+    // Bytes of the fixed fields - all of it without variable ones
+    static constexpr size_t fixed_bytes = layout::fixed_bytes;
+
+    static size_t size(const Tuple& v) {
+        return size(v, std::make_index_sequence<layout::n>{});
+    }
+
+    // out has size(v) bytes. Returns the end.
+    static std::byte* write(std::byte* out, const Tuple& v) {
+        return write(out, v, std::make_index_sequence<layout::n>{});
+    }
+
+    // Returns the end of the read bytes, nullptr if [in, end) is too short - v is then
+    // partly assigned
+    static const std::byte* read(const std::byte* in, const std::byte* end, Tuple& v) {
+        return read(in, end, v, std::make_index_sequence<layout::n>{});
+    }
+
+    static std::vector<std::byte> to_bytes(const Tuple& v) {
+        std::vector<std::byte> out(size(v));
+        write(out.data(), v);
+        return out;
+    }
+
+private:
+    template <size_t... Is>
+    static size_t size(const Tuple& v, std::index_sequence<Is...>) {
+        if constexpr (size_v<variable_fields> == 0) {
+            return fixed_bytes;
+        } else {
+            size_t total = fixed_bytes;
+            ((total += is_wire_fixed<std::tuple_element_t<Is, Tuple>>::value
+                           ? 0 : detail::wire_size(std::get<Is>(v))), ...);
+            return total;
+        }
+    }
+
+    template <size_t I>
+    static void write_field(std::byte*& out, const Tuple& v) {
+        using field_t = std::tuple_element_t<I, Tuple>;
+        constexpr auto f = layout::fields[I];
+        if constexpr (is_wire_fixed<field_t>::value) {
+            std::memcpy(out + f.offset, &std::get<I>(v), sizeof(field_t));
+            if constexpr (f.last) out += f.offset + sizeof(field_t);
+        } else {
+            out = wire_codec<field_t>::write(out, std::get<I>(v));
+        }
+    }
+
+    template <size_t... Is>
+    static std::byte* write(std::byte* out, const Tuple& v, std::index_sequence<Is...>) {
+        (write_field<Is>(out, v), ...);
+        return out;
+    }
+
+    template <size_t I>
+    static bool read_field(const std::byte*& in, const std::byte* end, Tuple& v) {
+        using field_t = std::tuple_element_t<I, Tuple>;
+        constexpr auto f = layout::fields[I];
+        if constexpr (is_wire_fixed<field_t>::value) {
+            if constexpr (f.run != 0) {
+                if (size_t(end - in) < f.run) return false;
+            }
+            std::memcpy(&std::get<I>(v), in + f.offset, sizeof(field_t));
+            if constexpr (f.last) in += f.offset + sizeof(field_t);
+            return true;
+        } else {
+            in = wire_codec<field_t>::read(in, end, std::get<I>(v));
+            return in != nullptr;
+        }
+    }
+
+    template <size_t... Is>
+    static const std::byte* read(const std::byte* in, const std::byte* end, Tuple& v,
+                                 std::index_sequence<Is...>) {
+        return (read_field<Is>(in, end, v) && ...) ? in : nullptr;
+    }
+};
+
+// Fields of a serialized tuple read in place, without decoding the rest - get<I> is
+// one unaligned load at a constant offset. Only for tuples of fixed fields, whose
+// wire format has a constant size. C++17 has no std::span, so it is a pointer and
+// a length - shorter than size throws std::out_of_range. The pointer-only
+// constructors, and next(), leave that check to the caller.
+
+template <class Tuple>
+class wire_view {
+    static_assert(size_v<filter_t<Tuple, is_wire_variable>> == 0,
+                  "wire_view needs trivially copyable fields - read the others with serialize");
+
+public:
+    using tuple_type = Tuple;
+    using offsets    = exclusive_scan_t<keys_t<Tuple, sizeof_key>>;
+
+    static constexpr size_t size = serialize<Tuple>::fixed_bytes;
+
+    template <size_t I>
+    static constexpr size_t offset_v = select_v<int(I), offsets>;
+
+    constexpr wire_view() = default;
+    explicit wire_view(const std::byte* data) : data_(data) {}
+    explicit wire_view(const void* data) : data_(static_cast<const std::byte*>(data)) {}
+
+    wire_view(const std::byte* data, size_t bytes) : data_(data) {
+        if (bytes < size) throw std::out_of_range("wire_view: buffer shorter than the record");
+    }
+
+    wire_view(const void* data, size_t bytes) : wire_view(static_cast<const std::byte*>(data), bytes) {}
+
+    const std::byte* data() const { return data_; }
+
+    template <size_t I>
+    std::tuple_element_t<I, Tuple> get() const {
+        std::tuple_element_t<I, Tuple> v;
+        std::memcpy(&v, data_ + offset_v<I>, sizeof(v));
+        return v;
+    }
+
+    Tuple to_tuple() const { return to_tuple(std::make_index_sequence<size_v<Tuple>>{}); }
+
+    // Views of consecutive records
+    wire_view next() const { return wire_view(data_ + size); }
+
+private:
+    const std::byte* data_ = nullptr;
+
+    template <size_t... Is>
+    Tuple to_tuple(std::index_sequence<Is...>) const { return Tuple(get<Is>()...); }
+};
+
+template <size_t I, class Tuple>
+std::tuple_element_t<I, Tuple> get(const wire_view<Tuple>& v) {
+    return v.template get<I>();
+}
+
+}  // namespace t
+
+// Structured bindings
+
+namespace std {
+
+template <class Tuple>
+struct tuple_size<t::wire_view<Tuple>> : tuple_size<Tuple> {};
+
+template <size_t I, class Tuple>
+struct tuple_element<I, t::wire_view<Tuple>> : tuple_element<I, Tuple> {};
+
+}  // namespace std
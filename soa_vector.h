@@ -0,0 +1,308 @@
+#pragma once
+
+#include "type_util.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace t {
+namespace detail {
+
+// Every column starts on its own cache line, so scanning one column never shares a
+// line with another
+
+inline constexpr size_t soa_alignment = 64;
+
+template <class T>
+inline constexpr size_t soa_column_alignment = alignof(T) > soa_alignment ? alignof(T) : soa_alignment;
+
+template <class T>
+T* soa_allocate(size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(soa_column_alignment<T>)));
+}
+
+template <class T>
+void soa_deallocate(T* p) {
+    ::operator delete(p, std::align_val_t(soa_column_alignment<T>));
+}
+
+// Moves a column into fresh storage, or copies it when some column's move could
+// throw - the std::move_if_noexcept rule, for all columns at once, so a failure in
+// one column cannot leave another already moved from
+
+template <bool Move, class T>
+T* soa_relocate(T* first, T* last, T* to) {
+    if constexpr (Move || !std::is_copy_constructible_v<T>)
+        return std::uninitialized_move(first, last, to);
+    else
+        return std::uninitialized_copy(first, last, to);
+}
+
+} // namespace detail
+
+// One column - a pointer and a size
+
+template <class T>
+class soa_span {
+public:
+    constexpr soa_span() = default;
+    constexpr soa_span(T* data, size_t size) : data_(data), size_(size) {}
+
+    constexpr T*     data()  const { return data_; }
+    constexpr size_t size()  const { return size_; }
+    constexpr bool   empty() const { return size_ == 0; }
+    constexpr T*     begin() const { return data_; }
+    constexpr T*     end()   const { return data_ + size_; }
+
+    constexpr T& operator[](size_t i) const { return data_[i]; }
+
+private:
+    T*     data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Some columns of a soa_vector, by pointer - does not own them.
+// Us are the column types, const when viewing a const vector.
+// Rows are tuples of references.
+
+template <class Columns> class soa_view;
+
+template <class... Us>
+class soa_view<std::tuple<Us...>> {
+public:
+    using tuple_type = std::tuple<std::remove_const_t<Us>...>;
+    using reference  = std::tuple<Us&...>;
+
+    constexpr soa_view(std::tuple<Us*...> columns, size_t size) : columns_(columns), size_(size) {}
+
+    constexpr size_t size()  const { return size_; }
+    constexpr bool   empty() const { return size_ == 0; }
+
+    template <size_t I>
+    constexpr auto column() const {
+        return soa_span<select_t<int(I), std::tuple<Us...>>>(std::get<I>(columns_), size_);
+    }
+
+    // The first column of type T
+    template <class T>
+    constexpr auto column() const {
+        static_assert(find_v<tuple_type, T> != end_v<tuple_type>, "no column of this type");
+        return column<find_v<tuple_type, T>>();
+    }
+
+    constexpr reference operator[](size_t i) const {
+        return std::apply([i](Us*... cols) { return reference(cols[i]...); }, columns_);
+    }
+
+private:
+    std::tuple<Us*...> columns_;
+    size_t             size_;
+};
+
+// Structure of arrays - one separately allocated, cache line aligned buffer per
+// tuple element. Rows are accessed through tuples of references, columns as
+// soa_span, and view<seq_t<size_t, ...>>() selects a few columns.
+
+template <class Tuple> class soa_vector;
+
+template <class... Ts>
+class soa_vector<std::tuple<Ts...>> {
+    using indices_t = std::index_sequence_for<Ts...>;
+
+public:
+    using tuple_type      = std::tuple<Ts...>;
+    using reference       = std::tuple<Ts&...>;
+    using const_reference = std::tuple<const Ts&...>;
+
+    soa_vector() = default;
+
+    // Delegates, so the destructor cleans up after a partial copy
+    soa_vector(const soa_vector& other) : soa_vector() {
+        reserve(other.size_);
+        for (size_t i = 0; i < other.size_; ++i) {
+            construct_row(indices_t{}, columns_, size_, other[i]);
+            ++size_;
+        }
+    }
+
+    soa_vector(soa_vector&& other) noexcept
+        : columns_(std::exchange(other.columns_, std::tuple<Ts*...>{}))
+        , size_(std::exchange(other.size_, 0))
+        , capacity_(std::exchange(other.capacity_, 0)) {}
+
+    soa_vector& operator=(soa_vector other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~soa_vector() {
+        clear();
+        release(columns_);
+    }
+
+    void swap(soa_vector& other) noexcept {
+        std::swap(columns_,  other.columns_);
+        std::swap(size_,     other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    size_t size()     const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool   empty()    const { return size_ == 0; }
+
+    void reserve(size_t n) {
+        if (n > capacity_) reallocate(n);
+    }
+
+    // One argument per column
+    template <class... Args>
+    reference emplace_back(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Ts), "one argument per column");
+        auto row = std::forward_as_tuple(std::forward<Args>(args)...);
+        // The arguments may be rows of this vector - when growing, the new row is
+        // built before the old columns go, as std::vector does
+        if (size_ == capacity_) reallocate(capacity_ ? 2 * capacity_ : 16, &row);
+        else                    construct_row(indices_t{}, columns_, size_, std::move(row));
+        return (*this)[size_++];
+    }
+
+    reference push_back(const tuple_type& row) {
+        return std::apply([this](const Ts&... v) { return emplace_back(v...); }, row);
+    }
+
+    reference push_back(tuple_type&& row) {
+        return std::apply([this](Ts&... v) { return emplace_back(std::move(v)...); }, row);
+    }
+
+    void pop_back() {
+        --size_;
+        std::apply([this](Ts*... cols) { (std::destroy_at(cols + size_), ...); }, columns_);
+    }
+
+    void clear() {
+        std::apply([this](Ts*... cols) { (std::destroy(cols, cols + size_), ...); }, columns_);
+        size_ = 0;
+    }
+
+    reference operator[](size_t i) {
+        return std::apply([i](Ts*... cols) { return reference(cols[i]...); }, columns_);
+    }
+
+    const_reference operator[](size_t i) const {
+        return std::apply([i](Ts*... cols) { return const_reference(cols[i]...); }, columns_);
+    }
+
+    template <size_t I>
+    auto column() {
+        return soa_span<select_t<int(I), tuple_type>>(std::get<I>(columns_), size_);
+    }
+
+    template <size_t I>
+    auto column() const {
+        return soa_span<const select_t<int(I), tuple_type>>(std::get<I>(columns_), size_);
+    }
+
+    // The first column of type T
+    template <class T>
+    auto column() {
+        static_assert(find_v<tuple_type, T> != end_v<tuple_type>, "no column of this type");
+        return column<find_v<tuple_type, T>>();
+    }
+
+    template <class T>
+    auto column() const {
+        static_assert(find_v<tuple_type, T> != end_v<tuple_type>, "no column of this type");
+        return column<find_v<tuple_type, T>>();
+    }
+
+    // Columns Is..., in that order
+    template <class Indices>
+    auto view() {
+        return make_view<Ts...>(Indices{}, columns_);
+    }
+
+    template <class Indices>
+    auto view() const {
+        return make_view<const Ts...>(Indices{}, columns_);
+    }
+
+private:
+    template <class... Us, class I, I... Is>
+    auto make_view(seq_t<I, Is...>, const std::tuple<Ts*...>& cols) const {
+        using view_t = soa_view<std::tuple<select_t<int(Is), std::tuple<Us...>>...>>;
+        return view_t({std::get<Is>(cols)...}, size_);
+    }
+
+    // Constructs row i of cols from a tuple of arguments, or none of it
+    template <size_t... Is, class Args>
+    static void construct_row(std::index_sequence<Is...>, const std::tuple<Ts*...>& cols, size_t i,
+                              Args&& args) {
+        size_t done = 0;
+        try {
+            ((::new (static_cast<void*>(std::get<Is>(cols) + i))
+                Ts(std::get<Is>(std::forward<Args>(args))), ++done), ...);
+        } catch (...) {
+            ((Is < done ? std::destroy_at(std::get<Is>(cols) + i) : void()), ...);
+            throw;
+        }
+    }
+
+    // Moves to columns of n rows, with row size_ built from *row first when there is
+    // one. The vector is unchanged if anything throws.
+    template <class Row = void>
+    void reallocate(size_t n, Row* row = nullptr) {
+        std::tuple<Ts*...> fresh{};
+        bool built = false;
+        try {
+            allocate_columns(indices_t{}, fresh, n);
+            if constexpr (!std::is_void_v<Row>) {
+                construct_row(indices_t{}, fresh, size_, std::move(*row));
+                built = true;
+            }
+            move_columns(indices_t{}, fresh);
+        } catch (...) {
+            if (built) std::apply([this](Ts*... cols) { (std::destroy_at(cols + size_), ...); }, fresh);
+            release(fresh);
+            throw;
+        }
+        std::apply([this](Ts*... cols) { (std::destroy(cols, cols + size_), ...); }, columns_);
+        release(columns_);
+        columns_  = fresh;
+        capacity_ = n;
+    }
+
+    // One column at a time, so the ones already allocated are in to if the next throws
+    template <size_t... Is>
+    static void allocate_columns(std::index_sequence<Is...>, std::tuple<Ts*...>& to, size_t n) {
+        ((std::get<Is>(to) = detail::soa_allocate<Ts>(n)), ...);
+    }
+
+    // Fills every new column before anything old is destroyed. On failure the
+    // columns already filled are destroyed and this vector is unchanged - unless a
+    // column can only be moved, by a move that may throw.
+    template <size_t... Is>
+    void move_columns(std::index_sequence<Is...>, const std::tuple<Ts*...>& to) {
+        size_t done = 0;
+        try {
+            constexpr bool move = (std::is_nothrow_move_constructible_v<Ts> && ...);
+            ((detail::soa_relocate<move>(std::get<Is>(columns_), std::get<Is>(columns_) + size_,
+                                         std::get<Is>(to)), ++done), ...);
+        } catch (...) {
+            ((Is < done ? std::destroy(std::get<Is>(to), std::get<Is>(to) + size_) : void()), ...);
+            throw;
+        }
+    }
+
+    static void release(const std::tuple<Ts*...>& cols) {
+        std::apply([](Ts*... p) { ((p ? detail::soa_deallocate(p) : void()), ...); }, cols);
+    }
+
+    std::tuple<Ts*...> columns_{};
+    size_t             size_     = 0;
+    size_t             capacity_ = 0;
+};
+
+}  // namespace t
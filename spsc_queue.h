@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace t {
+
+// Bounded single producer, single consumer queue - Capacity, a power of two, slots
+// in a ring. One thread pushes and closes, one thread pops. Each index is written by
+// one side only and lives on its own cache line, next to a cached copy of the other
+// side's index, so a push or pop touches the shared line only when the cache says
+// full or empty.
+
+template <class T, size_t Capacity = 1024>
+class spsc_queue {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                  "spsc_queue capacity must be a power of two");
+
+public:
+    using value_type = T;
+    static constexpr size_t capacity = Capacity;
+
+    spsc_queue() : slots_(new slot[Capacity]) {}
+
+    spsc_queue(const spsc_queue&)            = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    ~spsc_queue() {
+        size_t tail = prod_.index.load(std::memory_order_acquire);
+        for (size_t i = cons_.index.load(std::memory_order_relaxed); i != tail; ++i) {
+            slots_[i % Capacity].ptr()->~T();
+        }
+    }
+
+    // Producer side
+
+    template <class... Args>
+    bool try_emplace(Args&&... args) {
+        size_t tail = prod_.index.load(std::memory_order_relaxed);
+        if (tail - prod_.cached == Capacity) {
+            prod_.cached = cons_.index.load(std::memory_order_acquire);
+            if (tail - prod_.cached == Capacity) return false;
+        }
+        new (slots_[tail % Capacity].ptr()) T(std::forward<Args>(args)...);
+        prod_.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(T&& v)      { return try_emplace(std::move(v)); }
+    bool try_push(const T& v) { return try_emplace(v); }
+
+    // Waits for a free slot
+    template <class... Args>
+    void emplace(Args&&... args) {
+        while (!try_emplace(std::forward<Args>(args)...)) std::this_thread::yield();
+    }
+
+    void push(T&& v)      { emplace(std::move(v)); }
+    void push(const T& v) { emplace(v); }
+
+    // No more pushes - pop returns false once the queue is drained
+    void close() { closed_.store(true, std::memory_order_release); }
+
+    // Consumer side
+    // out is assigned the element - a T, or a std::optional<T> when T has no default
+    // constructor
+
+    template <class Out>
+    bool try_pop(Out& out) {
+        size_t head = cons_.index.load(std::memory_order_relaxed);
+        if (head == cons_.cached) {
+            cons_.cached = prod_.index.load(std::memory_order_acquire);
+            if (head == cons_.cached) return false;
+        }
+        T* p = slots_[head % Capacity].ptr();
+        out = std::move(*p);
+        p->~T();
+        cons_.index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Waits for an element, false when closed and empty
+    template <class Out>
+    bool pop(Out& out) {
+        while (!try_pop(out)) {
+            if (closed_.load(std::memory_order_acquire)) {
+                // Pushes before close are visible now
+                return try_pop(out);
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+private:
+    struct slot {
+        alignas(T) unsigned char bytes[sizeof(T)];
+        T* ptr() { return std::launder(reinterpret_cast<T*>(bytes)); }
+    };
+
+    // Own index, and the last seen index of the other side
+    struct alignas(64) side {
+        std::atomic<size_t> index{0};
+        size_t              cached = 0;
+    };
+
+    side                     prod_;
+    side                     cons_;
+    std::atomic<bool>        closed_{false};
+    std::unique_ptr<slot[]>  slots_;
+};
+
+}  // namespace t
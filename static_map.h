@@ -0,0 +1,144 @@
+#pragma once
+
+#include "type_util.h"
+#include "perfect_hash.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+namespace t {
+namespace detail {
+
+// Slot of each key and the key's position, in one array - a lookup is the hash, one
+// load and one compare. Empty slots hold position n, so whatever key they hold, the
+// lookup finds nothing there.
+// One multiply when a sparse enough table has no collisions, else the seeded two
+// level hash.
+
+template <class Seq>
+struct static_map_table {
+    using key_type = typename Seq::value_type;
+
+    static constexpr size_t n = size_v<Seq>;
+    static constexpr auto&  a = to_array_v<Seq>;
+
+    using direct = multiply_shift_hash<Seq>;
+    static constexpr bool one_multiply = direct::value.found;
+
+    // Without a hash, colliding keys would overwrite each other's entries
+    static_assert(std::disjunction_v<std::bool_constant<one_multiply>, hash_found<perfect_hash<Seq>>>,
+                  "static_map: no perfect hash found for these keys");
+
+    static constexpr size_t slots = [] {
+        if constexpr (one_multiply) return direct::slots;
+        else                        return perfect_hash<Seq>::slots;
+    }();
+
+    static constexpr size_t slot_of(key_type k) {
+        if constexpr (one_multiply) return direct::slot_of(k);
+        else                        return perfect_hash<Seq>::slot_of(k);
+    }
+
+    struct entry {
+        key_type       key;
+        uint_for_t<n>  index;
+    };
+
+    static constexpr std::array<entry, slots> entries = [] {
+        std::array<entry, slots> e{};
+        for (auto& x : e) x = {n ? a[0] : key_type(), uint_for_t<n>(n)};
+        for (size_t i = 0; i < n; ++i) e[slot_of(a[i])] = {a[i], uint_for_t<n>(i)};
+        return e;
+    }();
+
+    static constexpr size_t find(key_type k) {
+        const entry& e = entries[slot_of(k)];
+        return e.key == k ? size_t(e.index) : n;
+    }
+};
+
+} // namespace detail
+
+template <class Keys, class V> class static_map;
+
+// Map from a fixed set of integer keys to values of V. The values are one array in
+// key order - value i belongs to the key find_v<Keys, seq_t<K, key>> = i. A runtime
+// key is found with a perfect hash made at compile time, no probing:
+// (key * mult) >> shift, one load and one compare, for up to a few hundred keys.
+// Past that, or when no multiplier fits, a second multiply by a per bucket seed.
+//
+//     static_map<seq_t<uint8_t, 'A', 'D', 'E', 'X'>, handler_fn> handlers{on_add, ...};
+//     if (auto* h = handlers.find(msg.tag)) (*h)(msg);
+//
+// Keys known at compile time skip the hash - get<Key>().
+
+template <class K, K... Keys, class V>
+class static_map<seq_t<K, Keys...>, V> {
+    using keys_seq = seq_t<K, Keys...>;
+    using table    = detail::static_map_table<keys_seq>;
+    static_assert(size_v<unique_t<keys_seq>> == sizeof...(Keys), "static_map keys must be distinct");
+
+public:
+    using key_type    = K;
+    using mapped_type = V;
+
+    static constexpr size_t size = sizeof...(Keys);
+    static constexpr std::array<K, size> keys = {Keys...};
+
+    // Position of key, size if it is not a key
+    static constexpr size_t index_of(K key) { return table::find(key); }
+
+    static constexpr bool contains(K key) { return index_of(key) != size; }
+
+    constexpr static_map() = default;
+    constexpr explicit static_map(const std::array<V, size>& values) : values_(values) {}
+
+    // Values in key order
+    template <class... Vs, class = std::enable_if_t<sizeof...(Vs) == size && size != 0
+                                                    && (std::is_convertible_v<Vs, V> && ...)>>
+    constexpr static_map(Vs&&... values) : values_{{V(std::forward<Vs>(values))...}} {}
+
+    template <K Key>
+    constexpr V& get() { return values_[position<Key>()]; }
+
+    template <K Key>
+    constexpr const V& get() const { return values_[position<Key>()]; }
+
+    // nullptr when key is not a key
+    V* find(K key) {
+        size_t i = index_of(key);
+        return i != size ? &values_[i] : nullptr;
+    }
+
+    const V* find(K key) const {
+        size_t i = index_of(key);
+        return i != size ? &values_[i] : nullptr;
+    }
+
+    V& at(K key) {
+        if (V* v = find(key)) return *v;
+        throw std::out_of_range("t::static_map::at: not a key");
+    }
+
+    const V& at(K key) const {
+        if (const V* v = find(key)) return *v;
+        throw std::out_of_range("t::static_map::at: not a key");
+    }
+
+    std::array<V, size>&       values()       { return values_; }
+    const std::array<V, size>& values() const { return values_; }
+
+private:
+    std::array<V, size> values_{};
+
+    template <K Key>
+    static constexpr size_t position() {
+        constexpr size_t i = find_v<keys_seq, seq_t<K, Key>>;
+        static_assert(i != size, "static_map::get: not a key");
+        return i;
+    }
+};
+
+}  // namespace t
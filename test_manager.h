@@ -0,0 +1,275 @@
+#pragma once
+
+// Test harness for the type_util tests
+//
+// EXPECT_SAME / EXPECT_EQ run inside functions, at runtime.
+// STATIC_EXPECT_SAME / STATIC_EXPECT_EQ sit at namespace scope and check constant
+// expressions. Each becomes an entry of a constexpr table, closed by STATIC_TESTS()
+// at the end of the file:
+//  - by default the table is reported at runtime, like the other tests
+//  - with -DTEST_STATIC it is only checked, by one static_assert per file, so a failed
+//    type test stops the build and lists every failure of the file - line, expression
+//    and types - in the template arguments of static_test_failures<...>
+//
+// The tests are sharded - type_util_test.cpp has main() and the runtime tests, the
+// other *_test.cpp files the static ones. Compile the shards separately, in parallel,
+// and link them:
+//     for f in *_test.cpp; do c++ -std=c++17 -c $f & done; wait; c++ *_test.o
+
+#include "type_util.h"
+
+#include <string.h>
+
+#include <assert.h>
+#include <array>
+#include <iostream>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// One compile-time check, as reported at runtime
+
+struct static_result {
+    int              line;
+    bool             ok;
+    std::string_view expression;
+    void           (*details)(std::ostream&);  // Is: ... Expected: ...
+};
+
+class TestManager {
+    static TestManager*& _inst() {
+        static TestManager* inst = nullptr;
+        return inst;
+    }
+
+    static std::vector<void (*)()>& _tests() {
+        static std::vector<void (*)()> tests;
+        return tests;
+    }
+
+public:
+    TestManager() {
+        auto*& inst = _inst();
+        assert(inst == nullptr);
+        inst = this;
+    }
+    ~TestManager() {
+        auto*& inst = _inst();
+        inst = nullptr;
+    }
+
+    static TestManager& instance() {
+        return *_inst();
+    }
+
+    // Test functions of all shards, registered before main
+    struct registrar {
+        explicit registrar(void (*test)()) { _tests().push_back(test); }
+    };
+
+    void run_all() {
+        for (auto* test : _tests()) test();
+    }
+
+    template <class EXPR, class EXPECTED>
+    void expect_same(const char* filename, int line_num, const char* expression_str) {
+        test_count++;
+        std::cout << format_filename(filename) << ":" << line_num << " ";
+        if (!std::is_same_v<EXPR, EXPECTED>) {
+            fail_count++;
+            std::cout << fail_str() << "\n  " << expression_str        << "\n"
+                      << "Is:\n  "            << t::type_name_v<EXPR>     << "\n"
+                      << "Expected:\n  "      << t::type_name_v<EXPECTED> << "\n\n";
+        } else if (print_ok) {
+            std::cout << pass_str() << "    "
+                      << (print_ok_exp ? expression_str : "") << "\n";
+        }
+    }
+
+    template <class T1, class T2> // EXPRESSION, class EXPECTED>
+    void expect_eq(const char* filename, int line_num, const char* result_str,
+                   const char* expected_str, const T1& result, const T2& expected) {
+        test_count++;
+        std::cout << format_filename(filename) << ":" << line_num << " ";
+        if (result != T1(expected)) {
+            fail_count++;
+            std::cout << fail_str() << "\n  " << result_str   << "\n"
+                      << "Is:\n  "            << result       << "\n"
+                      << "Expected:\n  "      << expected_str
+                      << "  Which is "        << expected     << "\n\n";
+        } else if (print_ok) {
+            std::cout << pass_str() << "    "
+                      << (print_ok_exp ? result_str : "") << "\n";
+        }
+    }
+
+    void expect_static(const char* filename, const static_result& r) {
+        test_count++;
+        std::cout << format_filename(filename) << ":" << r.line << " ";
+        if (!r.ok) {
+            fail_count++;
+            std::cout << fail_str() << "\n  " << r.expression << "\n";
+            r.details(std::cout);
+            std::cout << "\n";
+        } else if (print_ok) {
+            std::cout << pass_str() << "    "
+                      << (print_ok_exp ? r.expression : "") << "\n";
+        }
+    }
+
+    int report() {
+        std::cout << "------\n"
+                  << "Total   " << test_count << " tests\n"
+                  << "\033[32mPASSED\033[0m  " << test_count - fail_count << " tests\n";
+        if (fail_count) {
+            std::cout << "\033[31mFAILED\033[0m  " << fail_count << " tests\n";
+        }
+        return fail_count ? 1 : 0;
+    }
+
+    bool print_ok        = true;
+    bool print_ok_exp    = true;
+    bool print_full_path = false;
+
+private:
+    int test_count = 0;
+    int fail_count = 0;
+
+    std::string_view format_filename(const char* filename) {
+        if (print_full_path) return filename;
+        const char* start = strrchr(filename, '/');
+        return start ? start + 1 : filename;
+    }
+
+    static const char* fail_str() { return "\033[31mFAIL\033[0m"; }
+    static const char* pass_str() { return "\033[32mOK\033[0m"; }
+};
+
+// Compile-time checks
+// static_case<N> is the check on the N-th __COUNTER__ of the file, or nothing - one
+// per TU, hence the unnamed namespace
+
+template <int Line, class Expr, class Expected>
+struct failed_same {};
+
+template <int Line, auto Value, auto Expected>
+struct failed_eq {};
+
+namespace {
+
+template <int N>
+struct static_case {
+    static constexpr int              line       = 0;
+    static constexpr bool             ok         = true;
+    static constexpr std::string_view expression = {};
+    using failures = std::tuple<>;
+
+    static void details(std::ostream&) {}
+};
+
+} // namespace
+
+template <int Line, class Expr, class Expected>
+struct same_case {
+    static constexpr bool ok = std::is_same_v<Expr, Expected>;
+    using failures = std::conditional_t<ok, std::tuple<>, std::tuple<failed_same<Line, Expr, Expected>>>;
+
+    static void details(std::ostream& os) {
+        os << "Is:\n  " << t::type_name_v<Expr> << "\nExpected:\n  " << t::type_name_v<Expected> << "\n";
+    }
+};
+
+template <int Line, auto Value, auto Expected>
+struct eq_case {
+    static constexpr bool ok = Value == decltype(Value)(Expected);
+    using failures = std::conditional_t<ok, std::tuple<>, std::tuple<failed_eq<Line, Value, Expected>>>;
+
+    static void details(std::ostream& os) {
+        os << "Is:\n  " << Value << "\nExpected:\n  " << Expected << "\n";
+    }
+};
+
+// Instantiated with the failures of a file - any at all and the static_assert fires,
+// with them in the "required from" note
+template <class Failures>
+struct static_test_failures {
+    static_assert(std::tuple_size_v<Failures> == 0,
+                  "static type tests failed - see the failed_same/failed_eq arguments");
+    static constexpr bool value = true;
+};
+
+namespace {
+
+template <class _Is> struct static_case_table;
+
+template <int... Is>
+struct static_case_table<std::integer_sequence<int, Is...>> {
+    // Counter values not used by a check have no line
+    static constexpr size_t count = (size_t(static_case<Is>::line != 0) + ... + 0);
+
+    static constexpr std::array<static_result, count> value = [] {
+        std::array<static_result, count> a{};
+        size_t k = 0;
+        ((static_case<Is>::line != 0
+            ? void(a[k++] = static_result{static_case<Is>::line, static_case<Is>::ok,
+                                          static_case<Is>::expression, &static_case<Is>::details})
+            : void()), ...);
+        return a;
+    }();
+
+    using failures = decltype(std::tuple_cat(std::declval<typename static_case<Is>::failures>()...));
+};
+
+} // namespace
+
+#define _UNPAREN_(...)  __VA_ARGS__
+
+#define EXPECT_SAME(EXPR, EXPECTED)                                         \
+    do {                                                                    \
+        TestManager::instance().expect_same<                                \
+            _UNPAREN_ EXPR, _UNPAREN_ EXPECTED>(__FILE__, __LINE__, #EXPR); \
+    } while (false)
+
+#define EXPECT_EQ(EXPR, EXPECTED)                                               \
+    do {                                                                        \
+        TestManager::instance().expect_eq(__FILE__, __LINE__, #EXPR, #EXPECTED, \
+            _UNPAREN_ EXPR, _UNPAREN_ EXPECTED);                                \
+    } while (false)
+
+#define _STATIC_CASE_(N, CASE, EXPR)                                        \
+    namespace {                                                             \
+    template <>                                                             \
+    struct static_case<N> : _UNPAREN_ CASE {                                \
+        static constexpr int              line       = __LINE__;            \
+        static constexpr std::string_view expression = #EXPR;               \
+    };                                                                      \
+    }
+
+#define STATIC_EXPECT_SAME(EXPR, EXPECTED) \
+    _STATIC_CASE_(__COUNTER__, (same_case<__LINE__, _UNPAREN_ EXPR, _UNPAREN_ EXPECTED>), EXPR)
+
+#define STATIC_EXPECT_EQ(EXPR, EXPECTED) \
+    _STATIC_CASE_(__COUNTER__, (eq_case<__LINE__, EXPR, EXPECTED>), EXPR)
+
+// A function of runtime tests, run by TestManager::run_all()
+
+#define TEST_FUNCTION(NAME)                                                 \
+    static void NAME();                                                     \
+    static const TestManager::registrar NAME##_registrar(&NAME);            \
+    static void NAME()
+
+#ifdef TEST_STATIC
+#define STATIC_TESTS()                                                                  \
+    static_assert(static_test_failures<                                                 \
+        static_case_table<std::make_integer_sequence<int, __COUNTER__>>::failures       \
+    >::value)
+#else
+#define STATIC_TESTS()                                                                  \
+    TEST_FUNCTION(static_tests) {                                                       \
+        using table = static_case_table<std::make_integer_sequence<int, __COUNTER__>>;  \
+        for (const auto& r : table::value) {                                            \
+            TestManager::instance().expect_static(__FILE__, r);                         \
+        }                                                                               \
+    }
+#endif
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "type_util.h"
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+namespace t {
+
+// A subset of the types of Universe, a tuple, as bits - bit i is type i of Universe.
+// One uint64_t for up to 64 types, more words past that. The word count is a
+// constant, so includes / intersects / count are an AND and a compare, or a POPCNT,
+// per word, unrolled.
+
+template <class Universe>
+class type_bitset {
+public:
+    using word_type = uint64_t;
+
+    static constexpr size_t size  = size_v<Universe>;
+    static constexpr size_t words = size == 0 ? 1 : (size + 63) / 64;
+
+    static_assert(size_v<unique_t<Universe>> == size, "type_bitset universe has repeated types");
+
+    // Bit of T
+    template <class T>
+    static constexpr size_t index_of() {
+        constexpr size_t i = find_v<Universe, T>;
+        static_assert(i != size, "type_bitset: type is not in the universe");
+        return i;
+    }
+
+    constexpr type_bitset() = default;
+
+    // The bits of Ts...
+    template <class... Ts>
+    static constexpr type_bitset of() {
+        type_bitset b;
+        (b.set(index_of<Ts>()), ...);
+        return b;
+    }
+
+    template <class T> constexpr type_bitset& set()        { return set(index_of<T>()); }
+    template <class T> constexpr type_bitset& reset()      { return reset(index_of<T>()); }
+    template <class T> constexpr bool         test() const { return test(index_of<T>()); }
+
+    constexpr type_bitset& set(size_t i) {
+        w_[i / 64] |= word_type(1) << (i % 64);
+        return *this;
+    }
+    constexpr type_bitset& reset(size_t i) {
+        w_[i / 64] &= ~(word_type(1) << (i % 64));
+        return *this;
+    }
+    constexpr bool test(size_t i) const {
+        return (w_[i / 64] >> (i % 64)) & 1;
+    }
+
+    // All of sub are here
+    constexpr bool includes(const type_bitset& sub) const {
+        word_type missing = 0;
+        for (size_t i = 0; i < words; ++i) missing |= sub.w_[i] & ~w_[i];
+        return missing == 0;
+    }
+
+    // Any of other is here
+    constexpr bool intersects(const type_bitset& other) const {
+        word_type common = 0;
+        for (size_t i = 0; i < words; ++i) common |= other.w_[i] & w_[i];
+        return common != 0;
+    }
+
+    constexpr size_t count() const {
+        size_t n = 0;
+        for (size_t i = 0; i < words; ++i) n += size_t(__builtin_popcountll(w_[i]));
+        return n;
+    }
+
+    constexpr bool any() const {
+        word_type bits = 0;
+        for (size_t i = 0; i < words; ++i) bits |= w_[i];
+        return bits != 0;
+    }
+    constexpr bool none() const { return !any(); }
+
+    constexpr word_type word(size_t i) const { return w_[i]; }
+
+    constexpr type_bitset& operator&=(const type_bitset& o) {
+        for (size_t i = 0; i < words; ++i) w_[i] &= o.w_[i];
+        return *this;
+    }
+    constexpr type_bitset& operator|=(const type_bitset& o) {
+        for (size_t i = 0; i < words; ++i) w_[i] |= o.w_[i];
+        return *this;
+    }
+    constexpr type_bitset& operator^=(const type_bitset& o) {
+        for (size_t i = 0; i < words; ++i) w_[i] ^= o.w_[i];
+        return *this;
+    }
+
+    // Complement within the universe - bits past size stay clear
+    constexpr type_bitset operator~() const {
+        type_bitset b;
+        for (size_t i = 0; i < words; ++i) b.w_[i] = ~w_[i];
+        if constexpr (size % 64 != 0 || size == 0) {
+            b.w_[words - 1] &= (word_type(1) << (size % 64)) - 1;
+        }
+        return b;
+    }
+
+    friend constexpr type_bitset operator&(type_bitset a, const type_bitset& b) { return a &= b; }
+    friend constexpr type_bitset operator|(type_bitset a, const type_bitset& b) { return a |= b; }
+    friend constexpr type_bitset operator^(type_bitset a, const type_bitset& b) { return a ^= b; }
+
+    friend constexpr bool operator==(const type_bitset& a, const type_bitset& b) {
+        word_type diff = 0;
+        for (size_t i = 0; i < words; ++i) diff |= a.w_[i] ^ b.w_[i];
+        return diff == 0;
+    }
+    friend constexpr bool operator!=(const type_bitset& a, const type_bitset& b) { return !(a == b); }
+
+private:
+    word_type w_[words] = {};
+};
+
+namespace detail {
+
+template <class Universe, class Subset> struct type_mask;
+
+template <class Universe, class... Ts>
+struct type_mask<Universe, std::tuple<Ts...>> {
+    static constexpr type_bitset<Universe> value = type_bitset<Universe>::template of<Ts...>();
+};
+
+} // namespace detail
+
+// The types of Subset, a tuple, as a constant type_bitset of Universe
+// A query like "has components A, C and F" is then
+//     record.mask.includes(type_mask_v<components, std::tuple<A, C, F>>)
+
+template <class Universe, class Subset>
+using type_mask = detail::type_mask<Universe, Subset>;
+
+template <class Universe, class Subset>
+inline constexpr type_bitset<Universe> type_mask_v = type_mask<Universe, Subset>::value;
+
+}  // namespace t
@@ -0,0 +1,32 @@
+// C++20 named module for type_util.h - `import t;` instead of #include "type_util.h"
+// Exports everything public in namespace t, detail stays internal.
+//
+// GCC:    g++ -std=c++20 -fmodules-ts -x c++ -c type_util.cppm
+//         (writes gcm.cache/t.gcm, found by later -fmodules-ts compiles in the same
+//          directory)
+// Clang:  clang++ -std=c++20 --precompile type_util.cppm -o t.pcm
+//         then -fmodule-file=t=t.pcm
+//
+// Without module support, precompile the header instead:
+// GCC:    g++ -std=c++17 -x c++-header type_util.h -o type_util.h.gch
+// Clang:  clang++ -std=c++17 -x c++-header type_util.h -o type_util.pch
+//         then -include-pch type_util.pch
+//
+// bench/include_bench.py compares the three on a generated project.
+
+module;
+
+// Every standard header type_util.h uses, so its own includes are no-ops inside
+// the module
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+export module t;
+
+#define T_EXPORT export
+#include "type_util.h"
@@ -1,8 +1,19 @@
+#pragma once
+
+// Empty, or export when included by the module interface, type_util.cppm.
+// #undef'd at the end of this file when it was defined here.
+#ifndef T_EXPORT
+#define T_EXPORT
+#define T_DETAIL_EXPORT_EMPTY
+#endif
+
 #include "type_util_impl.h"
 #include <type_traits>
 
 
-namespace t {
+T_EXPORT namespace t {
+
+// All indexing (select, head, tail, skip, erase, gather) is constant recursion depth
 
 // Sequence shorthand
 
@@ -10,7 +21,36 @@ template <typename T, T... Is>
 using seq_t = detail::seq_t<T, Is...>;
 
 template <typename T, T... Is>
-static constexpr auto seq_v = detail::seq_v<T, Is...>;
+inline constexpr auto seq_v = detail::seq_v<T, Is...>;
+
+// Round trip between sequences and constexpr arrays, for sequences too long for a
+// type per element - build a table with an ordinary constexpr function, then expand it
+// to_seq_t<ArrayConstant> expands ArrayConstant::value, a static constexpr std::array,
+// or its first ArrayConstant::count elements if ArrayConstant has a count
+// to_array_v<Seq> is the sequence as a std::array
+// Both are linear - sequences of 10k+ elements take seconds, not minutes
+
+template <class ArrayConstant>
+using to_seq = detail::to_seq<ArrayConstant>;
+
+template <class ArrayConstant>
+using to_seq_t = detail::to_seq_t<ArrayConstant>;
+
+template <class T>
+using to_array = detail::to_array<T>;
+
+template <class T>
+inline constexpr auto to_array_v = detail::to_array_v<T>;
+
+// A type carried as a value - type_tag<T>::type is T
+
+template <class T>
+using type_tag = detail::type_tag<T>;
+
+// Smallest unsigned type that holds N
+
+template <size_t N>
+using uint_for_t = detail::uint_for_t<N>;
 
 // Size of tuple or seq
 
@@ -18,9 +58,9 @@ template <class T>
 using size = detail::size<T>;
 
 template <class T>
-static constexpr size_t size_v = size<T>::value;
+inline constexpr size_t size_v = size<T>::value;
 
-// Concatenate tuples or sequences.
+// Concatenate tuples or sequences, any number of them in one pass.
 // Tuples concatenate with tuples of classes.
 // Sequences concatenate only with sequences.
 
@@ -71,53 +111,62 @@ template <int N, class T>
 using select_t = detail::select_t<N, T>;
 
 template <int N, class T>
-static constexpr auto select_v = detail::select_v<N, T>;
+inline constexpr auto select_v = detail::select_v<N, T>;
+
+// Pick many, like gather_t<seq_t<size_t, 2, 0>, T> == tuple<T[2], T[0]>
+// Indices may repeat and come in any order
+
+template <class Indices, class T>
+using gather = detail::gather<Indices, T>;
+
+template <class Indices, class T>
+using gather_t = detail::gather_t<Indices, T>;
 
 // Find the first type in tuple or something in sequence where Pred returns true.
 // Pred is used like - Pred<TestT, PredParam>::value
 // The "returned" value is "end()" if not found
 
 template <class T>
-static constexpr size_t end_v = detail::end_v<T>;  // size of T tuple of sequence
+inline constexpr size_t end_v = detail::end_v<T>;  // size of T tuple of sequence
 
 template <class Haystack, template <class, class> class Pred, class PredParam = void>
 using find_if = detail::find_if<Haystack, Pred, PredParam>;
 
 template <class Haystack, template <class, class> class Pred, class PredParam = void>
-static constexpr size_t find_if_v = detail::find_if_v<Haystack, Pred, PredParam>;
+inline constexpr size_t find_if_v = detail::find_if_v<Haystack, Pred, PredParam>;
 
 // Find type in tuple or literal in sequence
 // Thats like find_if(Haystack, [](T, Needle){ return T == Needle; }, Needle)
 
 template <class Haystack, class Needle>
-struct find {
-    static constexpr size_t value = find_if<Haystack, std::is_same, Needle>::value;
-};
+using find = detail::find<Haystack, Needle>;
 
 template <class Haystack, class Needle>
-static constexpr size_t find_v = find<Haystack, Needle>::value;
+inline constexpr size_t find_v = find<Haystack, Needle>::value;
+
+// Set of types with O(1) membership - type_set<Ts...>::contains<T>
+// as_type_set_t makes one from a tuple, or from a sequence as seq_t<T, I> singles
+
+template <class... Ts>
+using type_set = detail::type_set<Ts...>;
+
+template <class T>
+using as_type_set_t = detail::as_type_set_t<T>;
 
 // Find one of / not one of
+// Needles become a type_set, so this is O(N + M)
 
 template <class T, class G>
-struct is_one_of {
-    static constexpr bool value = find_v<G, T> != end_v<G>;
-};
+using is_one_of = detail::is_one_of<T, G>;
 
 template <class T, class G>
-struct is_not_one_of {
-    static constexpr bool value = find_v<G, T> == end_v<G>;
-};
+using is_not_one_of = detail::is_not_one_of<T, G>;
 
 template <class Haystack, class Needles>
-struct find_one_of {
-    static constexpr size_t value = find_if_v<Haystack, is_one_of, Needles>;
-};
+using find_one_of = detail::find_one_of<Haystack, Needles>;
 
 template <class Haystack, class Needles>
-struct find_not_one_of {
-    static constexpr size_t value = find_if_v<Haystack, is_not_one_of, Needles>;
-};
+using find_not_one_of = detail::find_not_one_of<Haystack, Needles>;
 
 template <class Haystack, class Needles>
 constexpr size_t find_one_of_v = find_one_of<Haystack, Needles>::value;
@@ -125,7 +174,23 @@ constexpr size_t find_one_of_v = find_one_of<Haystack, Needles>::value;
 template <class Haystack, class Needles>
 constexpr size_t find_not_one_of_v = find_not_one_of<Haystack, Needles>::value;
 
-// Filter a tuple or sequence
+// Set operations on tuples or sequences
+// Results are in order of first appearance, without duplicates
+// Sequences are sorted and searched by constexpr functions - O(N log N), fine for 10k+
+
+template <class T>
+using unique_t = detail::unique_t<T>;
+
+template <class A, class B>
+using union_t = detail::union_t<A, B>;
+
+template <class A, class B>
+using intersect_t = detail::intersect_t<A, B>;
+
+template <class A, class B>
+using difference_t = detail::difference_t<A, B>;
+
+// Filter a tuple or sequence - one pass, like Pred in find_if
 
 template <class T, template <class, class> class Pred, class PredParam = void>
 using filter = detail::filter<T, Pred, PredParam>;
@@ -141,18 +206,159 @@ using reverse = detail::reverse<T>;
 template <class T>
 using reverse_t = detail::reverse_t<T>;
 
+// Reverse by swapping halves - log N deep, mostly for comparison with reverse_t
+
+template <class T>
+using reverse2 = detail::reverse2<T>;
+
+template <class T>
+using reverse2_t = detail::reverse2_t<T>;
+
+// Transform each element - no recursion
+// Tuples become tuple<F<T>::type...>, sequences seq_t<T, F<seq_t<T, I>>::value...>
+
+template <class T, template <class> class F>
+using transform_t = detail::transform_t<T, F>;
+
+// Fold a sequence with Op (class with constexpr operator(), like std::plus<>),
+// left to right from Init
+
+template <class T, class Op = std::plus<>, typename T::value_type Init = 0>
+inline constexpr auto reduce_v = detail::reduce_v<T, Op, Init>;
+
+// Running fold of a sequence
+// exclusive_scan_t of sizes gives the offsets of packed fields
+
+template <class T, class Op = std::plus<>>
+using inclusive_scan_t = detail::inclusive_scan_t<T, Op>;
+
+template <class T, class Op = std::plus<>, typename T::value_type Init = 0>
+using exclusive_scan_t = detail::exclusive_scan_t<T, Op, Init>;
+
+// Tuple of rows - zip_t<A, B> is tuple<tuple<A[0], B[0]>, tuple<A[1], B[1]>, ...>
+// Sequence elements are seq_t<T, I>, as from select_t
+
+template <class... Lists>
+using zip_t = detail::zip_t<Lists...>;
+
+// Sequence of Begin, Begin + Step, ... before End - Step may be negative
+
+template <class T, T Begin, T End, T Step = 1>
+using iota_t = detail::iota_t<T, Begin, End, Step>;
+
 // Selection sort - O(N^2)
 // Select<Tuple or sequence>::value returns the index of the first one
 
 template <template <class> class Select, class T>
 using selection_sort = detail::selection_sort<Select, T>;
 
-// Sort sequence by less for this literal type
+// Minimum of sequence - index and value
 
 template <class T>
 using min = detail::min<T>;
 
+// Sort sequence - O(N log N) constexpr merge sort, no recursion
+// Stable - equal values keep their original order
+// Compare is a class with a constexpr operator(), like std::less<> (the default)
+
+template <class T, class Compare = std::less<>>
+using sorted_t = detail::sorted_t<T, Compare>;
+
+template <class T>
+using reverse_sorted_t = detail::reverse_sorted_t<T>;
+
+// Sort tuple or sequence by Key<T>::value - stable, O(N log N), one gather
+// sort_by<...>::permutation is seq_t<size_t, original index of each sorted element>
+// sort_by<...>::inverse is seq_t<size_t, sorted position of each original element>
+// sort_by<...>::value is the permutation as a constexpr std::array
+
+template <class T>
+using sizeof_key = detail::sizeof_key<T>;
+
 template <class T>
-using sorted_t = typename selection_sort<min, T>::type;
+using alignof_key = detail::alignof_key<T>;
+
+template <class T, template <class> class Key, class Compare = std::less<>>
+using sort_by = detail::sort_by<T, Key, Compare>;
+
+template <class T, template <class> class Key, class Compare = std::less<>>
+using sort_by_t = detail::sort_by_t<T, Key, Compare>;
+
+// Key<T>::value of each element as a sequence - keys_t<Tuple, sizeof_key> are the sizes
+
+template <class T, template <class> class Key>
+using keys_t = detail::keys_t<T, Key>;
+
+// Compile time type IDs - a 64 bit hash of the type's name, the same in every
+// translation unit built by one compiler. Without RTTI, type_id_v<T> is a cheap
+// std::unordered_map key for runtime registries.
+// type_id_key is the ID as a Key for sort_by and keys_t.
+
+template <class T>
+inline constexpr std::string_view type_name_v = detail::type_name_v<T>;
+
+template <class T>
+inline constexpr uint64_t type_id_v = detail::type_id_v<T>;
+
+template <class T>
+using type_id_key = detail::type_id_key<T>;
+
+// Tuple as a set in one normal form - sorted by type ID, duplicates dropped, so
+// canonical_t<tuple<int, char>> and canonical_t<tuple<char, int, char>> are one type
+// and templates keyed on it are instantiated once
+
+template <class T>
+using canonical = detail::canonical<T>;
+
+template <class T>
+using canonical_t = detail::canonical_t<T>;
+
+// Lazy expressions - steps joined with |, applied to a tuple or sequence at once
+//
+//     using e = decltype(lazy::skip<2> | lazy::filter<is_small> | lazy::reverse);
+//     lazy::apply_t<e, List>
+//
+// The steps move positions in one constexpr array - only the result is a type, one
+// gather of the source, however long the chain. Same results as the eager
+// skip_t, head_t, tail_t, erase_t, reverse_t, filter_t and gather_t.
+
+namespace lazy {
+
+template <class... Steps>
+using expr = detail::lazy_expr<Steps...>;
+
+template <int N>
+inline constexpr expr<detail::lazy_head<N>> head{};
+
+template <int N>
+inline constexpr expr<detail::lazy_tail<N>> tail{};
+
+template <int N>
+inline constexpr expr<detail::lazy_skip<N>> skip{};
+
+template <int I>
+inline constexpr expr<detail::lazy_erase<I>> erase{};
+
+inline constexpr expr<detail::lazy_reverse> reverse{};
+
+template <class Indices>
+inline constexpr expr<detail::lazy_gather<Indices>> gather{};
+
+template <template <class, class> class Pred, class PredParam = void>
+inline constexpr expr<detail::lazy_filter<Pred, PredParam>> filter{};
+
+// Positions of the result in the source, as seq_t<size_t, ...>
+template <class Expr, class T>
+using indices_t = typename detail::lazy_apply<Expr, T>::indices;
+
+template <class Expr, class T>
+using apply_t = detail::lazy_apply_t<Expr, T>;
+
+}  // namespace lazy
 
 }  // namespace t
+
+#ifdef T_DETAIL_EXPORT_EMPTY
+#undef T_EXPORT
+#undef T_DETAIL_EXPORT_EMPTY
+#endif
@@ -0,0 +1,78 @@
+#include "type_util.h"
+#include "test_manager.h"
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+
+using namespace t;
+
+// A table of squares mod 10007, built by an ordinary constexpr function
+template <size_t N>
+struct squares {
+    static constexpr std::array<int, N> value = [] {
+        std::array<int, N> a{};
+        for (size_t i = 0; i < N; ++i) a[i] = int(i * i % 10007);
+        return a;
+    }();
+};
+
+// The odd ones of a sequence, compacted to the front, with their count
+template <class Seq>
+struct odd_values {
+    static constexpr auto all = to_array_v<Seq>;
+    static constexpr size_t count = [] {
+        size_t c = 0;
+        for (auto v : all) c += v % 2;
+        return c;
+    }();
+    static constexpr auto value = [] {
+        auto a = all;
+        size_t j = 0;
+        for (auto v : all) {
+            if (v % 2) a[j++] = v;
+        }
+        return a;
+    }();
+};
+
+//
+// small
+//
+
+STATIC_EXPECT_SAME((to_seq_t<squares<5>>), (seq_t<int, 0, 1, 4, 9, 16>))
+STATIC_EXPECT_SAME((to_seq_t<squares<0>>), (seq_t<int>))
+STATIC_EXPECT_SAME((to_seq_t<odd_values<seq_t<int, 3, 4, 5, 6>>>), (seq_t<int, 3, 5>))
+STATIC_EXPECT_SAME((to_seq_t<odd_values<seq_t<int, 4, 6>>>), (seq_t<int>))
+STATIC_EXPECT_SAME((decltype(to_array_v<seq_t<uint8_t, 1, 2>>)), (const std::array<uint8_t, 2>))
+STATIC_EXPECT_EQ((to_array_v<seq_t<int, 7, -1, 3>>[1]), (-1))
+STATIC_EXPECT_EQ((to_array_v<seq_t<int>>.size()), (0))
+STATIC_EXPECT_SAME((to_seq_t<to_array<seq_t<char, 'a', 'b'>>>), (seq_t<char, 'a', 'b'>))
+
+// Set operations on sequences - empty sides, and value types that differ
+STATIC_EXPECT_SAME((unique_t<seq_t<int>>), (seq_t<int>))
+STATIC_EXPECT_SAME((intersect_t<seq_t<int, 1, 2>, seq_t<int>>), (seq_t<int>))
+STATIC_EXPECT_SAME((difference_t<seq_t<int, 2, 1, 2>, seq_t<int>>), (seq_t<int, 2, 1>))
+STATIC_EXPECT_SAME((intersect_t<seq_t<int, 1, 2>, seq_t<long, 1, 2>>), (seq_t<int>))
+STATIC_EXPECT_SAME((difference_t<seq_t<int, 1, 2>, seq_t<long, 1>>), (seq_t<int, 1, 2>))
+
+//
+// 10k elements
+//
+
+using big = to_seq_t<squares<10000>>;
+
+STATIC_EXPECT_EQ((size_v<big>), (10000))
+STATIC_EXPECT_EQ((select_v<9999, big>), (9999 * 9999 % 10007))
+STATIC_EXPECT_SAME((to_seq_t<to_array<big>>), (big))
+STATIC_EXPECT_SAME((reverse_t<reverse_t<big>>), (big))
+STATIC_EXPECT_EQ((select_v<0, sorted_t<big>>), (0))
+STATIC_EXPECT_EQ((select_v<9999, reverse_sorted_t<big>>), (0))
+// 0 and the (10007 - 1) / 2 quadratic residues, all reached by i < 5004
+STATIC_EXPECT_EQ((size_v<unique_t<big>>), (5004))
+STATIC_EXPECT_EQ((size_v<intersect_t<big, iota_t<int, 0, 100>>>), (size_v<unique_t<big>> - size_v<difference_t<big, iota_t<int, 0, 100>>>))
+STATIC_EXPECT_SAME((head_t<4, intersect_t<big, iota_t<int, 0, 100>>>), (seq_t<int, 0, 1, 4, 9>))
+STATIC_EXPECT_EQ((size_v<to_seq_t<odd_values<iota_t<int, 0, 20000>>>>), (10000))
+STATIC_EXPECT_EQ((select_v<9999, to_seq_t<odd_values<iota_t<int, 0, 20000>>>>), (19999))
+
+STATIC_TESTS();
@@ -0,0 +1,51 @@
+#include "type_util.h"
+#include "test_manager.h"
+
+#include <tuple>
+#include <type_traits>
+
+using namespace t;
+
+template <class T, class>
+struct bigger_than_1 {
+    static constexpr bool value = sizeof(T) > 1;
+};
+
+STATIC_EXPECT_EQ((find_if_v<std::tuple<char, int, long>, std::is_same, char>),  (0))
+STATIC_EXPECT_EQ((find_if_v<std::tuple<char, int, long>, std::is_same, int>),   (1))
+STATIC_EXPECT_EQ((find_if_v<std::tuple<char, int, long>, std::is_same, long>),  (2))
+STATIC_EXPECT_EQ((find_if_v<std::tuple<char, int, long>, std::is_same, short>), (3))
+
+STATIC_EXPECT_EQ((find_v<std::tuple<char, int, long>, char>),  (0))
+STATIC_EXPECT_EQ((find_v<std::tuple<char, int, long>, int>),   (1))
+STATIC_EXPECT_EQ((find_v<std::tuple<char, int, long>, long>),  (2))
+STATIC_EXPECT_EQ((find_v<std::tuple<char, int, long>, short>), (end_v<std::tuple<char, int, long>>))
+
+STATIC_EXPECT_EQ((find_one_of_v<std::tuple<char, int, long>, std::tuple<short>>),       (3))
+STATIC_EXPECT_EQ((find_one_of_v<std::tuple<char, int, long>, std::tuple<short, int>>),  (1))
+STATIC_EXPECT_EQ((find_one_of_v<std::tuple<char, int, long>, std::tuple<short, long>>), (2))
+
+STATIC_EXPECT_EQ((find_not_one_of_v<std::tuple<char, int, long>, std::tuple<char, int>>), (2))
+STATIC_EXPECT_EQ((find_not_one_of_v<std::tuple<char, int, long>, std::tuple<long, char, int>>), (3))
+
+STATIC_EXPECT_EQ((type_set<char, int, char>::contains<char>), (true))
+STATIC_EXPECT_EQ((type_set<char, int, char>::contains<long>), (false))
+STATIC_EXPECT_EQ((as_type_set_t<seq_t<int, 1, 2>>::contains<seq_t<int, 2>>), (true))
+
+STATIC_EXPECT_SAME((unique_t<std::tuple<char, int, char, long, int>>), (std::tuple<char, int, long>))
+STATIC_EXPECT_SAME((union_t<std::tuple<char, int>, std::tuple<long, char>>), (std::tuple<char, int, long>))
+STATIC_EXPECT_SAME((intersect_t<std::tuple<char, int, long, int>, std::tuple<long, int>>), (std::tuple<int, long>))
+STATIC_EXPECT_SAME((difference_t<std::tuple<char, int, long, char>, std::tuple<int>>), (std::tuple<char, long>))
+
+STATIC_EXPECT_SAME((unique_t<seq_t<int, 3, 1, 3, 2, 1>>), (seq_t<int, 3, 1, 2>))
+STATIC_EXPECT_SAME((union_t<seq_t<int, 3, 1>, seq_t<int, 2, 3>>), (seq_t<int, 3, 1, 2>))
+STATIC_EXPECT_SAME((intersect_t<seq_t<int, 3, 1, 2>, seq_t<int, 2, 3>>), (seq_t<int, 3, 2>))
+STATIC_EXPECT_SAME((difference_t<seq_t<int, 3, 1, 2>, seq_t<int, 2, 3>>), (seq_t<int, 1>))
+
+STATIC_EXPECT_SAME((filter_t<std::tuple<char, int, long>, bigger_than_1>),
+                   (std::tuple<int, long>))
+
+STATIC_EXPECT_SAME((filter_t<seq_t<int, 1, 2, 3, 5, 6, 7>, is_not_one_of, seq_t<int, 2, 3, 4>>),
+                   (seq_t<int, 1, 5, 6, 7>))
+
+STATIC_TESTS();
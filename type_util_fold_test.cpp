@@ -0,0 +1,69 @@
+#include "type_util.h"
+#include "test_manager.h"
+
+#include <cstdint>
+#include <functional>
+#include <tuple>
+
+using namespace t;
+
+template <class T>
+struct add_pointer {
+    using type = T*;
+};
+
+template <class T> struct times_3;
+
+template <class T, T I>
+struct times_3<seq_t<T, I>> {
+    static constexpr T value = I * 3;
+};
+
+struct max_of {
+    constexpr int operator()(int a, int b) const { return a < b ? b : a; }
+};
+
+//
+// transform
+//
+
+STATIC_EXPECT_SAME((transform_t<std::tuple<int, char>, add_pointer>), (std::tuple<int*, char*>))
+STATIC_EXPECT_SAME((transform_t<std::tuple<>, add_pointer>), (std::tuple<>))
+STATIC_EXPECT_SAME((transform_t<seq_t<int, 1, -2, 5>, times_3>), (seq_t<int, 3, -6, 15>))
+STATIC_EXPECT_SAME((keys_t<std::tuple<char, int32_t, double>, sizeof_key>), (seq_t<size_t, 1, 4, 8>))
+
+//
+// reduce / scan
+//
+
+STATIC_EXPECT_EQ((reduce_v<seq_t<int, 1, 2, 3, 4>>), (10))
+STATIC_EXPECT_EQ((reduce_v<seq_t<int, 1, 2, 3, 4>, std::multiplies<>, 1>), (24))
+STATIC_EXPECT_EQ((reduce_v<seq_t<int, 3, 9, -1>, max_of, -100>), (9))
+STATIC_EXPECT_EQ((reduce_v<seq_t<int>, std::plus<>, 7>), (7))
+STATIC_EXPECT_EQ((reduce_v<seq_t<int, 10, 3, 2>, std::minus<>, 20>), (5))
+
+STATIC_EXPECT_SAME((inclusive_scan_t<seq_t<int, 1, 2, 3, 4>>), (seq_t<int, 1, 3, 6, 10>))
+STATIC_EXPECT_SAME((inclusive_scan_t<seq_t<int, 3, 9, -1, 12>, max_of>), (seq_t<int, 3, 9, 9, 12>))
+STATIC_EXPECT_SAME((exclusive_scan_t<seq_t<int, 1, 2, 3, 4>>), (seq_t<int, 0, 1, 3, 6>))
+STATIC_EXPECT_SAME((exclusive_scan_t<seq_t<int, 1, 2, 3>, std::multiplies<>, 2>), (seq_t<int, 2, 2, 4>))
+STATIC_EXPECT_SAME((exclusive_scan_t<seq_t<int>>), (seq_t<int>))
+STATIC_EXPECT_SAME((exclusive_scan_t<keys_t<std::tuple<double, int32_t, char>, sizeof_key>>),
+                   (seq_t<size_t, 0, 8, 12>))
+
+//
+// zip / iota
+//
+
+STATIC_EXPECT_SAME((zip_t<std::tuple<int, char>, std::tuple<long, bool>>),
+                   (std::tuple<std::tuple<int, long>, std::tuple<char, bool>>))
+STATIC_EXPECT_SAME((zip_t<std::tuple<int>, seq_t<int, 5>, std::tuple<char>>),
+                   (std::tuple<std::tuple<int, seq_t<int, 5>, char>>))
+STATIC_EXPECT_SAME((zip_t<std::tuple<>>), (std::tuple<>))
+
+STATIC_EXPECT_SAME((iota_t<int, 0, 5>), (seq_t<int, 0, 1, 2, 3, 4>))
+STATIC_EXPECT_SAME((iota_t<int, 2, 11, 3>), (seq_t<int, 2, 5, 8>))
+STATIC_EXPECT_SAME((iota_t<int, 5, -1, -2>), (seq_t<int, 5, 3, 1>))
+STATIC_EXPECT_SAME((iota_t<int, 3, 3>), (seq_t<int>))
+STATIC_EXPECT_SAME((iota_t<size_t, 4, 2>), (seq_t<size_t>))
+
+STATIC_TESTS();
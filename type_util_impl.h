@@ -1,7 +1,12 @@
+#pragma once
+
 #include <type_traits>
 #include <tuple>
 #include <array>
 #include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <string_view>
 
 namespace t {
 namespace detail {
@@ -12,11 +17,11 @@ template <typename T, T... Is>
 using seq_t = std::integer_sequence<T, Is...>;
 
 template <typename T, T... Is>
-static constexpr std::array<T, sizeof...(Is)> seq_v = {Is...};
+inline constexpr std::array<T, sizeof...(Is)> seq_v = {Is...};
 
 // Size of tuple or seq
 
-static constexpr size_t npos = ~size_t(0);
+inline constexpr size_t npos = ~size_t(0);
 
 template <class _T>
 struct size;
@@ -32,261 +37,448 @@ struct size<std::tuple<Ts...>> {
 };
 
 template <class _T>
-static constexpr size_t size_v = size<_T>::value;
+inline constexpr size_t size_v = size<_T>::value;
 
-// Concatenate tuples or sequences
+// Smallest unsigned type that holds N
 
-template <class... _T>
-struct concat;
+template <size_t N>
+using uint_for_t = std::conditional_t<N <= UINT8_MAX,  uint8_t,
+                   std::conditional_t<N <= UINT16_MAX, uint16_t,
+                   std::conditional_t<N <= UINT32_MAX, uint32_t, uint64_t>>>;
+
+// A type carried as a value, so it can be passed and deduced without constructing it
 
-// 1 type
 template <class T>
-struct concat<T> {
-    using type = std::tuple<T>;
+struct type_tag {
+    using type = T;
 };
 
-template <class... Ts>
-struct concat<std::tuple<Ts...>> {
-    using type = std::tuple<Ts...>;
+// Expand a constexpr std::array member, Holder::value, into a sequence
+// The elements are read from a copy in a class of one type argument. GCC pays for
+// all the template arguments of the array's class on every element read, so reading
+// Holder::value of a specialization over a sequence is quadratic - minutes for 10k.
+
+template <class Holder>
+struct array_copy {
+    static constexpr auto value = Holder::value;
 };
 
-template <class T, T... Is>
-struct concat<seq_t<T, Is...>> {
-    using type = seq_t<T, Is...>;
+template <class Holder, class _Is> struct array_seq;
+
+template <class Holder, size_t... Is>
+struct array_seq<Holder, std::index_sequence<Is...>> {
+    using type = seq_t<typename decltype(Holder::value)::value_type, array_copy<Holder>::value[Is]...>;
 };
 
-// 2 types
-template <class T1, class T2>
-struct concat<T1, T2> {
-    using type = std::tuple<T1, T2>;
+// Round trip between constexpr arrays and sequences
+// ArrayConstant::value is a constexpr std::array, ArrayConstant::count, if present,
+// the number of leading elements used
+
+template <class ArrayConstant, class = void>
+struct array_count {
+    static constexpr size_t value = std::tuple_size<std::decay_t<decltype(ArrayConstant::value)>>::value;
 };
 
-template <class T1, class... T2s>
-struct concat<T1, std::tuple<T2s...>> {
-    using type = std::tuple<T1, T2s...>;
+template <class ArrayConstant>
+struct array_count<ArrayConstant, std::void_t<decltype(ArrayConstant::count)>> {
+    static constexpr size_t value = ArrayConstant::count;
 };
 
-template <class... T1s, class T2>
-struct concat<std::tuple<T1s...>, T2> {
-    using type = std::tuple<T1s..., T2>;
+template <class ArrayConstant>
+struct to_seq {
+    using type = typename array_seq<ArrayConstant,
+                                    std::make_index_sequence<array_count<ArrayConstant>::value>>::type;
 };
 
-template <class... T1s, class... T2s>
-struct concat<std::tuple<T1s...>, std::tuple<T2s...>> {
-    using type = std::tuple<T1s..., T2s...>;
+template <class ArrayConstant>
+using to_seq_t = typename to_seq<ArrayConstant>::type;
+
+template <class _T> struct to_array;
+
+template <class T, T... Is>
+struct to_array<seq_t<T, Is...>> {
+    static constexpr std::array<T, sizeof...(Is)> value = {Is...};
 };
 
-template <class T, T... I1s, T... I2s>
-struct concat<seq_t<T, I1s...>, seq_t<T, I2s...>> {
-    using type = seq_t<T, I1s..., I2s...>;
+template <class _T>
+inline constexpr auto to_array_v = to_array<_T>::value;
+
+// Index ranges
+// std::make_index_sequence is a compiler builtin (__integer_pack / __make_integer_seq)
+// so these are constant depth
+
+template <size_t Offset, class _T> struct offset_seq;
+
+template <size_t Offset, size_t... Is>
+struct offset_seq<Offset, std::index_sequence<Is...>> {
+    using type = std::index_sequence<(Offset + Is)...>;
 };
 
-// 2+ types = 1 type + 1+ types
-template <class T1, class T2, class... Ts>
-struct concat<T1, T2, Ts...> {
-    using type = typename concat<
-                    typename concat<T1>::type,
-                    typename concat<T2, Ts...>::type
-                >::type;
+template <size_t Begin, size_t End>
+using index_range_t = typename offset_seq<Begin, std::make_index_sequence<End - Begin>>::type;
+
+// Pick one
+// __type_pack_element (clang, GCC 14) is constant time. The fallback is one
+// deduction, but the compiler still walks all N bases, so each lookup is O(N) and
+// anything that does N lookups - gather_t, and so reverse_t and filter_t on
+// tuples - is quadratic. GCC 12 at N=2048: reverse_t 5.5 s / 1.3 GB, filter_t
+// 3.1 s / 0.8 GB. T_DETAIL_TYPE_PACK_ELEMENT is #undef'd at the end of this file.
+
+#if defined(__has_builtin)
+#  if __has_builtin(__type_pack_element)
+#    define T_DETAIL_TYPE_PACK_ELEMENT 1
+#  endif
+#endif
+
+#ifndef T_DETAIL_TYPE_PACK_ELEMENT
+// Overload resolution fallback - the base matching index I is deduced in one step
+
+template <size_t I, class T>
+struct indexed {
+    using type = T;
 };
 
-template <class... Ts>
-using concat_t = typename concat<Ts...>::type;
+template <class _Is, class... Ts> struct indexer;
 
-// First few
+template <size_t... Is, class... Ts>
+struct indexer<std::index_sequence<Is...>, Ts...> : indexed<Is, Ts>... {};
 
-template <int N, class _T, bool Stop = (N == 0)> struct head;
+template <size_t I, class T>
+indexed<I, T> select_base(const indexed<I, T>&);
+#endif
 
-template <int N, class T, class... Ts>
-struct head<N, std::tuple<T, Ts...>, false> {
-    using type = concat_t<
-                    T,
-                    typename head<
-                        N - 1,
-                        std::tuple<Ts...>
-                    >::type
-                 >;
+template <int N, class _T> struct select;
+
+template <int N, class... Ts>
+struct select<N, std::tuple<Ts...>> {
+    static_assert(N >= 0 && size_t(N) < sizeof...(Ts), "select index out of range");
+#ifdef T_DETAIL_TYPE_PACK_ELEMENT
+    using type = __type_pack_element<N, Ts...>;
+#else
+    using type = typename decltype(select_base<N>(
+                    indexer<std::index_sequence_for<Ts...>, Ts...>{}))::type;
+#endif
 };
 
-template <class T, class... Ts>
-struct head<0, std::tuple<T, Ts...>, true> {
-    using type = std::tuple<>;
+template <int N, class T, T... Is>
+struct select<N, seq_t<T, Is...>> {
+    static_assert(N >= 0 && size_t(N) < sizeof...(Is), "select index out of range");
+    static constexpr T value = seq_v<T, Is...>[N];
+    using type               = seq_t<T, value>;
 };
 
-template <int N, class T, T I, T... Is>
-struct head<N, seq_t<T, I, Is...>, false> {
-    using type = concat_t<
-                    seq_t<T, I>,
-                    typename head<
-                        N - 1,
-                        seq_t<T, Is...>
-                    >::type
-                 >;
+template <int N, class _T>
+using select_t = typename select<N, _T>::type;
+
+template <int N, class _T>
+inline constexpr auto select_v = select<N, _T>::value;
+
+// Pick many, in one instantiation
+
+template <class Indices, class _T> struct gather;
+
+template <class I, I... Is, class... Ts>
+struct gather<seq_t<I, Is...>, std::tuple<Ts...>> {
+    using type = std::tuple<select_t<int(Is), std::tuple<Ts...>>...>;
 };
 
-template <class T, T... Is>
-struct head<0, seq_t<T, Is...>, true> {
-    using type = seq_t<T>;
+// Sequences pick into an array, expanded by array_seq
+template <class I, I... Is, class T, T... Vs>
+struct gather<seq_t<I, Is...>, seq_t<T, Vs...>> {
+    static constexpr std::array<T, sizeof...(Is)> value = [] {
+        constexpr std::array<T, sizeof...(Vs)> a = {Vs...};
+        return std::array<T, sizeof...(Is)>{a[Is]...};
+    }();
+    using type = typename array_seq<gather, std::make_index_sequence<sizeof...(Is)>>::type;
 };
 
-template <int N, class _T>
-using head_t = typename head<N, _T>::type;
+template <class Indices, class _T>
+using gather_t = typename gather<Indices, _T>::type;
 
-// Last few
+// Concatenate tuples or sequences
+// A balanced tree of pairs, in log2(N) rounds of constant depth. The lists stay in
+// place: after the round of step s, list i (i a multiple of 2s) holds lists
+// [i, i + 2s) and the others are spent. A round pairs each list with the one s
+// places later, from a copy of the arguments shifted by one dropper deduction -
+// no lookups by index, and each element is copied log2(N) times.
 
-template <int N, class _T, bool Stop = (N == size_v<_T>)> struct tail;
+template <class T>
+struct as_tuple {
+    using type = std::tuple<T>;
+};
 
-template <int N, class... Ts>
-struct tail<N, std::tuple<Ts...>, true> {
+template <class... Ts>
+struct as_tuple<std::tuple<Ts...>> {
     using type = std::tuple<Ts...>;
 };
 
-template <int N, class T, class... Ts>
-struct tail<N, std::tuple<T, Ts...>, false> {
-    using type = typename tail<
-                    N,
-                    std::tuple<Ts...>
-                >::type;
+template <class _T>
+inline constexpr bool is_seq = false;
+
+template <class T, T... Is>
+inline constexpr bool is_seq<seq_t<T, Is...>> = true;
+
+// All of Bs, without a fold expression - GCC nests a fold over N terms N deep, and
+// at thousands of terms the fold costs more than the concatenation itself
+template <bool...> struct bool_pack;
+
+template <bool... Bs>
+inline constexpr bool all_of_v = std::is_same_v<bool_pack<Bs...>, bool_pack<(void(Bs), true)...>>;
+
+// Drops the first N of the arguments in one deduction - the first N are matched by
+// void*, the rest are deduced. Linear work, unlike N select_t lookups.
+
+template <class _Is> struct dropper;
+
+template <size_t... Is>
+struct dropper<std::index_sequence<Is...>> {
+    template <class... Rest>
+    static std::tuple<typename Rest::type...> drop(decltype((void*)Is)..., Rest*...);
 };
 
-template <int N, class T, T... Is>
-struct tail<N, seq_t<T, Is...>, true> {
-    using type = seq_t<T, Is...>;
+template <class A, class B> struct concat_pair;
+
+template <class... As, class... Bs>
+struct concat_pair<std::tuple<As...>, std::tuple<Bs...>> {
+    using type = std::tuple<As..., Bs...>;
 };
 
-template <int N, class T, T I, T... Is>
-struct tail<N, seq_t<T, I, Is...>, false> {
-    using type = typename tail<
-                    N,
-                    seq_t<T, Is...>
-                >::type;
+template <class T, T... As, T... Bs>
+struct concat_pair<seq_t<T, As...>, seq_t<T, Bs...>> {
+    using type = seq_t<T, As..., Bs...>;
 };
 
-template <int N, class _T>
-using tail_t = typename tail<N, _T>::type;
+// Lists shifted left by Step, padded at the end with Step empty lists
+template <class Empty, class _Pad, class... Lists> struct concat_shift;
 
-// A few past the start
+template <class Empty, size_t... Pad, class... Lists>
+struct concat_shift<Empty, std::index_sequence<Pad...>, Lists...> {
+    // The padding is an expression, not an alias template per element - an alias
+    // expanded over Pad triples the cost of the whole concatenation on GCC
+    using type = decltype(dropper<std::index_sequence<Pad...>>::drop(
+                    static_cast<type_tag<Lists>*>(nullptr)...,
+                    (void(Pad), static_cast<type_tag<Empty>*>(nullptr))...));
+};
 
-template <int N, class _T, bool Stop = (N == 0)> struct skip;
+template <class Empty, size_t Step, class _Is, class Lists, class Shifted> struct concat_round;
 
-template <class... Ts>
-struct skip<0, std::tuple<Ts...>, true> {
-    using type = std::tuple<Ts...>;
+template <class Empty, size_t Step, size_t... Is, class... Lists, class... Shifted>
+struct concat_round<Empty, Step, std::index_sequence<Is...>,
+                    std::tuple<Lists...>, std::tuple<Shifted...>> {
+    using type = std::tuple<typename std::conditional_t<Is % (2 * Step) == 0,
+                                                        concat_pair<Lists, Shifted>,
+                                                        type_tag<Empty>>::type...>;
 };
 
-template <int N, class T, class... Ts>
-struct skip<N, std::tuple<T, Ts...>, false> {
-    using type = typename skip<
-                    N - 1,
-                    std::tuple<Ts...>
-                >::type;
+template <class Empty, size_t Step, class Lists, bool = (Step < size_v<Lists>)>
+struct concat_tree {
+    using type = std::tuple_element_t<0, Lists>;
 };
 
-template <class T, T... Is>
-struct skip<0, seq_t<T, Is...>, true> {
-    using type = seq_t<T, Is...>;
+template <class Empty, size_t Step, class... Lists>
+struct concat_tree<Empty, Step, std::tuple<Lists...>, true>
+    : concat_tree<Empty, 2 * Step, typename concat_round<
+          Empty, Step, std::index_sequence_for<Lists...>, std::tuple<Lists...>,
+          typename concat_shift<Empty, std::make_index_sequence<Step>, Lists...>::type>::type> {};
+
+template <class Empty, size_t Step>
+struct concat_tree<Empty, Step, std::tuple<>, false> {
+    using type = Empty;
 };
 
-template <int N, class T, T I, T... Is>
-struct skip<N, seq_t<T, I, Is...>, false> {
-    using type = typename skip<
-                    N - 1,
-                    seq_t<T, Is...>
-                >::type;
+template <class Empty, class... Lists>
+using concat_lists_t = typename concat_tree<Empty, 1, std::tuple<Lists...>>::type;
+
+template <class... Tuples>
+using concat_tuples_t = concat_lists_t<std::tuple<>, Tuples...>;
+
+// Evaluated only when picked by a conditional, as_tuple included
+template <class... Ts>
+struct lazy_concat_tuples {
+    using type = concat_tuples_t<typename as_tuple<Ts>::type...>;
 };
 
-template <int N, class _T>
-using skip_t = typename skip<N, _T>::type;
+template <class T, class... Seqs>
+struct concat_seqs {
+    static_assert(all_of_v<std::is_same_v<typename Seqs::value_type, T>...>,
+                  "sequences concatenate only with sequences of the same type");
+    using type = concat_lists_t<seq_t<T>, Seqs...>;
+};
 
-// Remove one
+// Tuples flatten, anything else - including a sequence mixed with non-sequences -
+// is one element
 
-template <int I, class _T> struct erase {
-    using type = concat_t<
-                    head_t<I, _T>,
-                    skip_t<I + 1, _T>
-                >;
+template <class... _T>
+struct concat {
+    using type = concat_tuples_t<typename as_tuple<_T>::type...>;
 };
 
-template <int I, class _T>
-using erase_t = typename erase<I, _T>::type;
+template <class... T1s, class... T2s>
+struct concat<std::tuple<T1s...>, std::tuple<T2s...>> {
+    using type = std::tuple<T1s..., T2s...>;
+};
 
-// Pick one
+template <class T, T... Is, class... Seqs>
+struct concat<seq_t<T, Is...>, Seqs...> {
+    using type = typename std::conditional_t<
+                    all_of_v<is_seq<Seqs>...>,
+                    concat_seqs<T, seq_t<T, Is...>, Seqs...>,
+                    lazy_concat_tuples<std::tuple<seq_t<T, Is...>>, Seqs...>
+                 >::type;
+};
 
-template <int N, class _T, bool Stop = (N == 0)> struct select;
+template <class T, T... Is>
+struct concat<seq_t<T, Is...>> {
+    using type = seq_t<T, Is...>;
+};
 
-template <class T, class... Ts>
-struct select<0, std::tuple<T, Ts...>, true> {
-    using type = T;
+template <class T, T... I1s, T... I2s>
+struct concat<seq_t<T, I1s...>, seq_t<T, I2s...>> {
+    using type = seq_t<T, I1s..., I2s...>;
 };
 
-template <int N, class T, class... Ts>
-struct select<N, std::tuple<T, Ts...>, false> {
-    using type = typename select<
-                    N - 1,
-                    std::tuple<Ts...>
-                >::type;
+template <class... Ts>
+using concat_t = typename concat<Ts...>::type;
+
+// First few
+
+template <int N, class _T> struct head {
+    using type = gather_t<std::make_index_sequence<N>, _T>;
 };
 
-template <class T, T I, T... Is>
-struct select<0, seq_t<T, I, Is...>, true> {
-    using type      = seq_t<T, I>;
-    static constexpr T value = I;
+template <int N, class _T>
+using head_t = typename head<N, _T>::type;
+
+// A few past the start
+// Tuples drop the first N in one deduction, with dropper
+
+template <int N, class _T> struct skip {
+    using type = gather_t<index_range_t<N, size_v<_T>>, _T>;
 };
 
-template <int N, class T, T I, T... Is>
-struct select<N, seq_t<T, I, Is...>, false> {
-    using type      = typename select<N - 1, seq_t<T, Is...>>::type;
-    static constexpr T value = select<N - 1, seq_t<T, Is...>>::value;
+template <int N, class... Ts>
+struct skip<N, std::tuple<Ts...>> {
+    using type = decltype(dropper<std::make_index_sequence<N>>::drop(
+                    static_cast<type_tag<Ts>*>(nullptr)...));
 };
 
 template <int N, class _T>
-using select_t = typename select<N, _T>::type;
+using skip_t = typename skip<N, _T>::type;
+
+// Last few
+
+template <int N, class _T> struct tail {
+    using type = skip_t<int(size_v<_T>) - N, _T>;
+};
 
 template <int N, class _T>
-static constexpr auto select_v = select<N, _T>::value;
+using tail_t = typename tail<N, _T>::type;
+
+// Remove one - the indices around I, then one gather, so no tuple in between
+
+template <int I, class _T> struct erase {
+    using type = gather_t<concat_t<std::make_index_sequence<I>, index_range_t<I + 1, size_v<_T>>>, _T>;
+};
+
+template <int I, class _T>
+using erase_t = typename erase<I, _T>::type;
 
 // Find the first type in tuple or int in sequence that Pred
 // The "returned" value is "end()" if not found
+// Every Pred is evaluated side by side into a bool array, then scanned - no recursion
 
 template <class Haystack>
-static constexpr size_t end_v = size_v<Haystack>;
+inline constexpr size_t end_v = size_v<Haystack>;
 
-template <class Haystack,
-          template <class, class> class Pred,
-          class PredParam = void,
-          bool Stop = (size_v<Haystack> == 0)>
+template <size_t N>
+constexpr size_t first_true(const std::array<bool, N>& a) {
+    size_t i = 0;
+    while (i < N && !a[i]) ++i;
+    return i;
+}
+
+template <class Haystack, template <class, class> class Pred, class PredParam = void>
 struct find_if;
 
-template <class Haystack, template <class, class> class Pred, class PredParam>
-struct find_if<Haystack, Pred, PredParam, true> {
-    static constexpr size_t value = 0;
+template <class... Ts, template <class, class> class Pred, class PredParam>
+struct find_if<std::tuple<Ts...>, Pred, PredParam> {
+    static constexpr std::array<bool, sizeof...(Ts)> match = {Pred<Ts, PredParam>::value...};
+    static constexpr size_t value = first_true(match);
 };
 
-template <class Haystack, template <class, class> class Pred, class PredParam>
-struct find_if<Haystack, Pred, PredParam, false> {
-    static constexpr size_t value = Pred<select_t<0, Haystack>, PredParam>::value ? 0
-                                    : (1 + find_if<skip_t<1, Haystack>, Pred, PredParam>::value);
+template <class T, T... Is, template <class, class> class Pred, class PredParam>
+struct find_if<seq_t<T, Is...>, Pred, PredParam> {
+    static constexpr std::array<bool, sizeof...(Is)> match = {Pred<seq_t<T, Is>, PredParam>::value...};
+    static constexpr size_t value = first_true(match);
 };
 
 template <class Haystack, template <class, class> class Pred, class PredParam = void>
-static constexpr size_t find_if_v = find_if<Haystack, Pred, PredParam>::value;
+inline constexpr size_t find_if_v = find_if<Haystack, Pred, PredParam>::value;
+
+// find is find_if with std::is_same, but uses is_same_v directly - a builtin, so no
+// class instantiation per element
 
 template <class Haystack, class Needle>
-struct find {
-    static constexpr size_t value = find_if<Haystack, std::is_same, Needle>::value;
+struct find;
+
+template <class... Ts, class Needle>
+struct find<std::tuple<Ts...>, Needle> {
+    static constexpr std::array<bool, sizeof...(Ts)> match = {std::is_same_v<Ts, Needle>...};
+    static constexpr size_t value = first_true(match);
+};
+
+template <class T, T... Is, class Needle>
+struct find<seq_t<T, Is...>, Needle> {
+    static constexpr std::array<bool, sizeof...(Is)> match = {std::is_same_v<seq_t<T, Is>, Needle>...};
+    static constexpr size_t value = first_true(match);
 };
 
 template <class Haystack, class Needle>
-static constexpr size_t find_v = find<Haystack, Needle>::value;
+inline constexpr size_t find_v = find<Haystack, Needle>::value;
+
+// Set of types with constant time membership
+// Each type is a base, so membership is a single is_base_of. Duplicates are fine -
+// they just make the base ambiguous, which is_base_of does not care about.
+
+template <size_t I, class T>
+struct type_set_entry : type_tag<T> {};
+
+template <class _Is, class... Ts> struct type_set_base;
+
+template <size_t... Is, class... Ts>
+struct type_set_base<std::index_sequence<Is...>, Ts...> : type_set_entry<Is, Ts>... {};
+
+template <class... Ts>
+struct type_set : type_set_base<std::index_sequence_for<Ts...>, Ts...> {
+    template <class T>
+    static constexpr bool contains = std::is_base_of_v<type_tag<T>, type_set>;
+};
+
+// Tuple of types, or sequence of seq_t<T, I> singles, same as find_if sees them
+
+template <class _T> struct as_type_set;
+
+template <class... Ts>
+struct as_type_set<std::tuple<Ts...>> {
+    using type = type_set<Ts...>;
+};
+
+template <class T, T... Is>
+struct as_type_set<seq_t<T, Is...>> {
+    using type = type_set<seq_t<T, Is>...>;
+};
+
+template <class _T>
+using as_type_set_t = typename as_type_set<_T>::type;
 
 template <class T, class _T>
 struct is_one_of {
-    static constexpr bool value = find_v<_T, T> != end_v<_T>;
+    static constexpr bool value = as_type_set_t<_T>::template contains<T>;
 };
 
 template <class T, class _T>
 struct is_not_one_of {
-    static constexpr bool value = find_v<_T, T> == end_v<_T>;
+    static constexpr bool value = !as_type_set_t<_T>::template contains<T>;
 };
 
 template <class Haystack, class Needles>
@@ -305,77 +497,119 @@ constexpr size_t find_one_of_v = find_one_of<Haystack, Needles>::value;
 template <class Haystack, class Needles>
 constexpr size_t find_not_one_of_v = find_not_one_of<Haystack, Needles>::value;
 
-// Filter a tuple or sequence
+// Keep the elements where Keep is true, in one gather
+
+template <class _T, class Keep> struct compress;
+
+template <class _T, bool... Bs>
+struct compress<_T, seq_t<bool, Bs...>> {
+    static_assert(sizeof...(Bs) == size_v<_T>, "compress mask size mismatch");
+    static constexpr std::array<bool, sizeof...(Bs)> keep = {Bs...};
+    static constexpr size_t count = (size_t(Bs) + ... + 0);
+    // Positions of the kept elements
+    static constexpr std::array<size_t, count> value = [] {
+        std::array<size_t, count> a{};
+        size_t j = 0;
+        for (size_t i = 0; i < keep.size(); ++i) {
+            if (keep[i]) a[j++] = i;
+        }
+        return a;
+    }();
+    using type = gather_t<
+                    typename array_seq<compress, std::make_index_sequence<count>>::type,
+                    _T
+                >;
+};
 
-template <class _T, template <class, class> class Pred, class PredParam = void> struct filter;
+template <class _T, class Keep>
+using compress_t = typename compress<_T, Keep>::type;
 
-template <class T, template <class, class> class Pred, class PredParam>
-struct filter<std::tuple<T>, Pred, PredParam> {
-    using type = std::conditional_t<Pred<T, PredParam>::value, std::tuple<T>, std::tuple<>>;
-};
+// Filter a tuple or sequence
+// All Preds side by side into a mask, then one compress
 
-template <class T, class... Ts, template <class, class> class Pred, class PredParam>
-struct filter<std::tuple<T, Ts...>, Pred, PredParam> {
-    using type = concat_t<
-                    typename filter<std::tuple<T>,     Pred, PredParam>::type,
-                    typename filter<std::tuple<Ts...>, Pred, PredParam>::type
-                >;
-};
+template <class _T, template <class, class> class Pred, class PredParam = void> struct filter;
 
-template <class T, T I, template <class, class> class Pred, class PredParam>
-struct filter<seq_t<T, I>, Pred, PredParam> {
-    using type = std::conditional_t<Pred<seq_t<T, I>, PredParam>::value, seq_t<T, I>, seq_t<T>>;
+template <class... Ts, template <class, class> class Pred, class PredParam>
+struct filter<std::tuple<Ts...>, Pred, PredParam> {
+    using type = compress_t<std::tuple<Ts...>, seq_t<bool, Pred<Ts, PredParam>::value...>>;
 };
 
-template <class T, T I, T... Is, template <class, class> class Pred, class PredParam>
-struct filter<seq_t<T, I, Is...>, Pred, PredParam> {
-    using type = concat_t<
-                    typename filter<seq_t<T, I>, Pred, PredParam>::type,
-                    typename filter<seq_t<T, Is...>, Pred, PredParam>::type
-                >;
+template <class T, T... Is, template <class, class> class Pred, class PredParam>
+struct filter<seq_t<T, Is...>, Pred, PredParam> {
+    using type = compress_t<seq_t<T, Is...>, seq_t<bool, Pred<seq_t<T, Is>, PredParam>::value...>>;
 };
 
 template <class _T, template <class, class> class Pred, class PredParam = void>
 using filter_t = typename filter<_T, Pred, PredParam>::type;
 
+// Set operations
+// Results keep the order of first appearance and have no duplicates
 
-// Reverse a tuple or sequence
+// A type that appears once converts to its unambiguous type_tag base, and is kept
+// without searching. Only repeated types pay for a find_v.
 
-template <class _T> struct reverse;
+template <class Set, class T, size_t I, class List>
+inline constexpr bool first_occurrence = std::is_convertible_v<const Set*, const type_tag<T>*>
+                                         || find_v<List, T> == I;
 
-template <class T>
-struct reverse<std::tuple<T>> {
-    using type = std::tuple<T>;
+template <class _T, class _Is = std::make_index_sequence<size_v<_T>>> struct unique;
+
+template <class... Ts, size_t... Is>
+struct unique<std::tuple<Ts...>, std::index_sequence<Is...>> {
+    using list_t = std::tuple<Ts...>;
+    using set_t  = type_set<Ts...>;
+    using type   = compress_t<list_t, seq_t<bool, first_occurrence<set_t, Ts, Is, list_t>...>>;
 };
 
-template <class T, class... Ts>
-struct reverse<std::tuple<T, Ts...>> {
-    using type = concat_t<
-                    typename reverse<std::tuple<Ts...>>::type,
-                    std::tuple<T>
-                >;
+// Sequences are specialized after sort - see Set operations on sequences
+
+template <class _T>
+using unique_t = typename unique<_T>::type;
+
+template <class A, class B>
+using union_t = unique_t<concat_t<A, B>>;
+
+template <class A, class B>
+struct intersect {
+    using type = filter_t<unique_t<A>, is_one_of, B>;
 };
 
-template <class T, T I>
-struct reverse<seq_t<T, I>> {
-    using type = seq_t<T, I>;
+template <class A, class B>
+using intersect_t = typename intersect<A, B>::type;
+
+template <class A, class B>
+struct difference {
+    using type = filter_t<unique_t<A>, is_not_one_of, B>;
 };
 
-template <class T, T I, T... Is>
-struct reverse<seq_t<T, I, Is...>> {
-    using type = concat_t<
-                    typename reverse<seq_t<T, Is...>>::type,
-                    seq_t<T, I>
-                >;
+template <class A, class B>
+using difference_t = typename difference<A, B>::type;
+
+// Reverse a tuple or sequence - one gather of the reversed indices
+
+template <size_t N, class _Is = std::make_index_sequence<N>> struct reverse_index;
+
+template <size_t N, size_t... Is>
+struct reverse_index<N, std::index_sequence<Is...>> {
+    using type = std::index_sequence<(N - 1 - Is)...>;
+};
+
+template <class _T> struct reverse {
+    using type = gather_t<typename reverse_index<size_v<_T>>::type, _T>;
 };
 
 template <class _T>
 using reverse_t = typename reverse<_T>::type;
 
-// Reverse a tuple or sequence differently
+// Reverse a tuple or sequence differently - halves, log N deep
 
 template <class _T> struct reverse2;
 
+template <>
+struct reverse2<std::tuple<>> {
+    using type = std::tuple<>;
+};
+
 template <class T>
 struct reverse2<std::tuple<T>> {
     using type = std::tuple<T>;
@@ -390,6 +624,11 @@ struct reverse2<std::tuple<Ts...>> {
                 >;
 };
 
+template <class T>
+struct reverse2<seq_t<T>> {
+    using type = seq_t<T>;
+};
+
 template <class T, T I>
 struct reverse2<seq_t<T, I>> {
     using type = seq_t<T, I>;
@@ -407,6 +646,109 @@ struct reverse2<seq_t<T, Is...>> {
 template <class _T>
 using reverse2_t = typename reverse2<_T>::type;
 
+// Transform each element
+// Tuples - F<T>::type for each T. Sequences - F<seq_t<T, I>>::value for each I, as in find_if
+
+template <class _T, template <class> class F> struct transform;
+
+template <class... Ts, template <class> class F>
+struct transform<std::tuple<Ts...>, F> {
+    using type = std::tuple<typename F<Ts>::type...>;
+};
+
+template <class T, T... Is, template <class> class F>
+struct transform<seq_t<T, Is...>, F> {
+    using type = seq_t<T, T(F<seq_t<T, Is>>::value)...>;
+};
+
+template <class _T, template <class> class F>
+using transform_t = typename transform<_T, F>::type;
+
+// Fold a sequence with Op, left to right, starting from Init
+// The accumulator overloads << so a fold expression applies Op
+
+template <class T, class Op>
+struct fold_acc {
+    T value;
+
+    friend constexpr fold_acc operator<<(fold_acc a, T b) {
+        return {T(Op{}(a.value, b))};
+    }
+};
+
+template <class _T, class Op, auto Init> struct reduce;
+
+template <class T, T... Is, class Op, auto Init>
+struct reduce<seq_t<T, Is...>, Op, Init> {
+    static constexpr T value = (fold_acc<T, Op>{T(Init)} << ... << Is).value;
+};
+
+template <class _T, class Op = std::plus<>, typename _T::value_type Init = 0>
+inline constexpr auto reduce_v = reduce<_T, Op, Init>::value;
+
+// Running fold of a sequence - element i of the inclusive scan includes element i,
+// of the exclusive one it does not, and the exclusive one starts with Init
+
+template <class _T, class Op, bool Inclusive, auto Init> struct scan;
+
+template <class T, T... Is, class Op, bool Inclusive, auto Init>
+struct scan<seq_t<T, Is...>, Op, Inclusive, Init> {
+    static constexpr std::array<T, sizeof...(Is)> value = [] {
+        std::array<T, sizeof...(Is)> a = {Is...};
+        T acc = T(Init);
+        for (size_t i = 0; i < a.size(); ++i) {
+            T next = (Inclusive && i == 0) ? a[i] : T(Op{}(acc, a[i]));
+            a[i] = Inclusive ? next : acc;
+            acc  = next;
+        }
+        return a;
+    }();
+    using type = typename array_seq<scan, std::make_index_sequence<sizeof...(Is)>>::type;
+};
+
+template <class _T, class Op = std::plus<>>
+using inclusive_scan_t = typename scan<_T, Op, true, 0>::type;
+
+template <class _T, class Op = std::plus<>, typename _T::value_type Init = 0>
+using exclusive_scan_t = typename scan<_T, Op, false, Init>::type;
+
+// Element i of every list, side by side
+
+template <class _Is, class... Lists> struct zip;
+
+template <size_t... Is, class... Lists>
+struct zip<std::index_sequence<Is...>, Lists...> {
+    template <size_t I>
+    using row = std::tuple<select_t<int(I), Lists>...>;
+    using type = std::tuple<row<Is>...>;
+};
+
+template <class List, class... Lists>
+struct zip_lists {
+    static_assert(((size_v<Lists> == size_v<List>) && ...), "zip needs lists of the same size");
+    using type = typename zip<std::make_index_sequence<size_v<List>>, List, Lists...>::type;
+};
+
+template <class... Lists>
+using zip_t = typename zip_lists<Lists...>::type;
+
+// Begin, Begin + Step, ... up to but not including End
+
+template <class T, T Begin, T End, T Step>
+struct iota {
+    static_assert(Step != 0, "iota step must not be 0");
+    static constexpr size_t count = Step > 0 ? (End > Begin ? size_t((End - Begin + Step - 1) / Step) : 0)
+                                             : (Begin > End ? size_t((Begin - End - Step - 1) / -Step) : 0);
+
+    template <size_t... Is>
+    static seq_t<T, T(Begin + T(Is) * Step)...> make(std::index_sequence<Is...>);
+
+    using type = decltype(make(std::make_index_sequence<count>{}));
+};
+
+template <class T, T Begin, T End, T Step = 1>
+using iota_t = typename iota<T, Begin, End, Step>::type;
+
 // Selection sort - O(N^2)
 
 template <template <class> class Select, class _T> struct selection_sort;
@@ -454,15 +796,446 @@ struct min;
 
 template <class T, T... Is>
 struct min<seq_t<T, Is...>> {
-    static constexpr auto a = seq_v<T, Is...>;
+    static constexpr auto& a = to_array_v<seq_t<T, Is...>>;
     static constexpr size_t index = std::min_element(a.begin(), a.end()) - a.begin();
     static constexpr T      value = a[index];
 };
 
+// Sort a sequence
+// The values are copied into an array once, sorted by a constexpr function, and
+// expanded back - no instantiation per element.
+// Compare is a class with a constexpr operator(), like std::less<>
+
+// Bottom-up merge sort - stable, no recursion
+// Works on plain local arrays - the constant evaluator is several times slower
+// through std::array::operator[]
+
+template <class T, size_t N, class Compare>
+constexpr std::array<T, N> merge_sorted(const std::array<T, N>& in, Compare comp) {
+    T x[N + 1] = {};
+    T y[N + 1] = {};
+    for (size_t k = 0; k < N; ++k) x[k] = in[k];
+    // Passes alternate between the two buffers
+    T* a = x;
+    T* b = y;
+    for (size_t w = 1; w < N; w *= 2) {
+        for (size_t lo = 0; lo < N; lo += 2 * w) {
+            size_t mid = std::min(lo + w, N), hi = std::min(lo + 2 * w, N);
+            size_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) b[k++] = comp(a[j], a[i]) ? a[j++] : a[i++];
+            while (i < mid) b[k++] = a[i++];
+            while (j < hi)  b[k++] = a[j++];
+        }
+        T* c = a;
+        a = b;
+        b = c;
+    }
+    std::array<T, N> out{};
+    for (size_t k = 0; k < N; ++k) out[k] = a[k];
+    return out;
+}
+
+template <class _T, class Compare> struct sort;
+
+template <class T, T... Is, class Compare>
+struct sort<seq_t<T, Is...>, Compare> {
+    static constexpr std::array<T, sizeof...(Is)> value = merge_sorted(to_array_v<seq_t<T, Is...>>, Compare{});
+    using type = typename array_seq<sort, std::make_index_sequence<sizeof...(Is)>>::type;
+};
+
+template <class _T, class Compare = std::less<>>
+using sorted_t = typename sort<_T, Compare>::type;
+
 template <class _T>
-using sorted_t = typename selection_sort<min, _T>::type;
+using reverse_sorted_t = sorted_t<_T, std::greater<>>;
+
+// Sort a tuple or sequence by a key per element
+// Key<T>::value is computed once per element, the indices are sorted by key and the
+// result is one gather. permutation[sorted position] = original index, and inverse
+// is the other way round.
+
+template <class T>
+struct sizeof_key {
+    static constexpr size_t value = sizeof(T);
+};
+
+template <class T>
+struct alignof_key {
+    static constexpr size_t value = alignof(T);
+};
+
+template <class _T, template <class> class Key> struct key_array;
+
+template <class... Ts, template <class> class Key>
+struct key_array<std::tuple<Ts...>, Key> {
+    using key_t = std::common_type_t<int, std::decay_t<decltype(Key<Ts>::value)>...>;
+    static constexpr std::array<key_t, sizeof...(Ts)> value = {key_t(Key<Ts>::value)...};
+};
+
+template <class T, T... Is, template <class> class Key>
+struct key_array<seq_t<T, Is...>, Key> {
+    using key_t = std::common_type_t<int, std::decay_t<decltype(Key<seq_t<T, Is>>::value)>...>;
+    static constexpr std::array<key_t, sizeof...(Is)> value = {key_t(Key<seq_t<T, Is>>::value)...};
+};
+
+// Key<T>::value of each element as a sequence
+
+template <class _T, template <class> class Key>
+using keys_t = typename array_seq<key_array<_T, Key>, std::make_index_sequence<size_v<_T>>>::type;
+
+template <class Keys, class Compare>
+struct key_compare {
+    constexpr bool operator()(size_t a, size_t b) const {
+        return Compare{}(Keys::value[a], Keys::value[b]);
+    }
+};
+
+template <size_t N>
+constexpr std::array<size_t, N> iota_array() {
+    std::array<size_t, N> a{};
+    for (size_t i = 0; i < N; ++i) a[i] = i;
+    return a;
+}
+
+template <class Perm>
+struct inverse_permutation {
+    static constexpr auto value = [] {
+        auto a = Perm::value;
+        for (size_t i = 0; i < a.size(); ++i) a[Perm::value[i]] = i;
+        return a;
+    }();
+};
+
+template <class _T, template <class> class Key, class Compare = std::less<>>
+struct sort_by {
+    static constexpr size_t n = size_v<_T>;
+    static constexpr std::array<size_t, n> value =
+        merge_sorted(iota_array<n>(), key_compare<key_array<_T, Key>, Compare>{});
+
+    using permutation = typename array_seq<sort_by, std::make_index_sequence<n>>::type;
+    using inverse     = typename array_seq<inverse_permutation<sort_by>,
+                                           std::make_index_sequence<n>>::type;
+    using type        = gather_t<permutation, _T>;
+};
+
+template <class _T, template <class> class Key, class Compare = std::less<>>
+using sort_by_t = typename sort_by<_T, Key, Compare>::type;
+
+// Type IDs - FNV-1a of the compiler's spelling of the type, from the function
+// signature of type_name<T>. Stable across translation units and runs of one
+// compiler, not across compilers.
+
+template <class T>
+constexpr std::string_view type_name() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    std::string_view f = __FUNCSIG__;
+    const size_t begin = f.find("type_name<") + 10;
+    const size_t end   = f.rfind(">(void)");
+#else
+    std::string_view f = __PRETTY_FUNCTION__;
+    const size_t begin = f.find("T = ") + 4;
+    size_t end = f.find(';', begin);
+    if (end == std::string_view::npos) end = f.rfind(']');
+#endif
+    return f.substr(begin, end - begin);
+}
+
+constexpr uint64_t fnv1a(std::string_view s) {
+    uint64_t h = 14695981039346656037ull;
+    for (char c : s) {
+        h ^= uint64_t(static_cast<unsigned char>(c));
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+template <class T>
+inline constexpr std::string_view type_name_v = type_name<T>();
+
+template <class T>
+inline constexpr uint64_t type_id_v = fnv1a(type_name_v<T>);
+
+template <class T>
+struct type_id_key {
+    static constexpr uint64_t value = type_id_v<T>;
+};
+
+// Canonical form of a tuple used as a set - sorted by type ID, without duplicates.
+// Two different types with one ID would sort by their order in the list, so that
+// is refused.
+
+template <class _T>
+struct canonical {
+    using type = unique_t<sort_by_t<_T, type_id_key>>;
+
+    static constexpr bool distinct_ids = [] {
+        const auto& ids = to_array_v<keys_t<type, type_id_key>>;
+        for (size_t i = 1; i < ids.size(); ++i) {
+            if (ids[i - 1] == ids[i]) return false;
+        }
+        return true;
+    }();
+    static_assert(distinct_ids, "canonical_t: two types of the list have the same type ID");
+};
+
+template <class _T>
+using canonical_t = typename canonical<_T>::type;
+
+// Set operations on sequences
+// Sequences are values, not types - they are sorted once by a constexpr function
+// and searched, O(N log N) with no instantiation per element
+
+// Both below work on plain local arrays, like merge_sorted, and search inline -
+// a constexpr call per element costs more than the search
+
+// keep[i] = false where a[i] is not the first occurrence of its value - equal values
+// find the same slot of the sorted copy
+template <class T, size_t N>
+constexpr void keep_first_occurrences(const std::array<T, N>& a, std::array<bool, N>& keep) {
+    std::array<T, N> sorted = merge_sorted(a, std::less<>());
+    T s[N + 1] = {};
+    T v[N + 1] = {};
+    bool seen[N + 1] = {};
+    for (size_t i = 0; i < N; ++i) {
+        s[i] = sorted[i];
+        v[i] = a[i];
+    }
+    for (size_t i = 0; i < N; ++i) {
+        size_t lo = 0, hi = N;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (s[mid] < v[i]) lo = mid + 1;
+            else               hi = mid;
+        }
+        if (seen[lo]) keep[i] = false;
+        seen[lo] = true;
+    }
+}
+
+// keep[i] = false where whether a[i] is in b is not Member
+template <bool Member, class T, size_t N, size_t M>
+constexpr void keep_members(const std::array<T, N>& a, const std::array<T, M>& b,
+                            std::array<bool, N>& keep) {
+    std::array<T, M> sorted = merge_sorted(b, std::less<>());
+    T s[M + 1] = {};
+    T v[N + 1] = {};
+    for (size_t i = 0; i < M; ++i) s[i] = sorted[i];
+    for (size_t i = 0; i < N; ++i) v[i] = a[i];
+    for (size_t i = 0; i < N; ++i) {
+        size_t lo = 0, hi = M;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (s[mid] < v[i]) lo = mid + 1;
+            else               hi = mid;
+        }
+        if ((lo < M && !(v[i] < s[lo])) != Member) keep[i] = false;
+    }
+}
+
+// The values of A whose membership in B is Member, without duplicates
+// Over the sequence types, not their values - the members of a specialization on the
+// values are slow to read element by element, see array_seq
+
+template <bool Member, class A, class B>
+struct set_filter {
+    using value_type = typename A::value_type;
+    static constexpr size_t n = size_v<A>;
+    static constexpr std::array<bool, n> keep = [] {
+        std::array<bool, n> k{};
+        for (bool& x : k) x = true;
+        keep_first_occurrences(to_array_v<A>, k);
+        keep_members<Member>(to_array_v<A>, to_array_v<B>, k);
+        return k;
+    }();
+    static constexpr size_t count = [] {
+        size_t c = 0;
+        for (bool k : keep) c += k;
+        return c;
+    }();
+    static constexpr std::array<value_type, count> value = [] {
+        const auto& a = to_array_v<A>;
+        std::array<value_type, count> out{};
+        for (size_t i = 0, j = 0; i < n; ++i) {
+            if (keep[i]) out[j++] = a[i];
+        }
+        return out;
+    }();
+    using type = typename array_seq<set_filter, std::make_index_sequence<count>>::type;
+};
+
+template <class T, T... Vs, size_t... Is>
+struct unique<seq_t<T, Vs...>, std::index_sequence<Is...>> {
+    // Not a member of the empty set
+    using type = typename set_filter<false, seq_t<T, Vs...>, seq_t<T>>::type;
+};
+
+template <class T, T... As, T... Bs>
+struct intersect<seq_t<T, As...>, seq_t<T, Bs...>> {
+    using type = typename set_filter<true, seq_t<T, As...>, seq_t<T, Bs...>>::type;
+};
+
+template <class T, T... As, T... Bs>
+struct difference<seq_t<T, As...>, seq_t<T, Bs...>> {
+    using type = typename set_filter<false, seq_t<T, As...>, seq_t<T, Bs...>>::type;
+};
+
+// Lazy expressions - a chain of index operations run on one array of positions into
+// the source, then one gather. The steps in between are never types.
+
+// Not constexpr - reaching it makes the expression fail to compile, with this name in
+// the error
+inline void lazy_index_out_of_range() {}
+
+template <class _T, template <class, class> class Pred, class PredParam> struct lazy_mask;
+
+template <class... Ts, template <class, class> class Pred, class PredParam>
+struct lazy_mask<std::tuple<Ts...>, Pred, PredParam> {
+    using type = seq_t<bool, Pred<Ts, PredParam>::value...>;
+};
+
+template <class T, T... Is, template <class, class> class Pred, class PredParam>
+struct lazy_mask<seq_t<T, Is...>, Pred, PredParam> {
+    using type = seq_t<bool, Pred<seq_t<T, Is>, PredParam>::value...>;
+};
+
+// Each step rewrites idx[0, n) in place - Src is the source list
+
+template <int N>
+struct lazy_head {
+    template <class Src>
+    static constexpr void run(size_t*, size_t& n) {
+        if (N < 0 || size_t(N) > n) lazy_index_out_of_range();
+        n = size_t(N);
+    }
+};
+
+template <int N>
+struct lazy_skip {
+    template <class Src>
+    static constexpr void run(size_t* idx, size_t& n) {
+        if (N < 0 || size_t(N) > n) lazy_index_out_of_range();
+        for (size_t i = size_t(N); i < n; ++i) idx[i - N] = idx[i];
+        n -= size_t(N);
+    }
+};
+
+template <int N>
+struct lazy_tail {
+    template <class Src>
+    static constexpr void run(size_t* idx, size_t& n) {
+        if (N < 0 || size_t(N) > n) lazy_index_out_of_range();
+        for (size_t i = 0; i < size_t(N); ++i) idx[i] = idx[n - size_t(N) + i];
+        n = size_t(N);
+    }
+};
+
+template <int I>
+struct lazy_erase {
+    template <class Src>
+    static constexpr void run(size_t* idx, size_t& n) {
+        if (I < 0 || size_t(I) >= n) lazy_index_out_of_range();
+        for (size_t i = size_t(I) + 1; i < n; ++i) idx[i - 1] = idx[i];
+        --n;
+    }
+};
+
+struct lazy_reverse {
+    template <class Src>
+    static constexpr void run(size_t* idx, size_t& n) {
+        for (size_t i = 0; i < n / 2; ++i) {
+            size_t x = idx[i];
+            idx[i] = idx[n - 1 - i];
+            idx[n - 1 - i] = x;
+        }
+    }
+};
+
+// May repeat positions, so the result can outgrow the source - width is the room it
+// needs
+template <class Indices>
+struct lazy_gather {
+    static constexpr size_t width = size_v<Indices>;
+
+    template <class Src>
+    static constexpr void run(size_t* idx, size_t& n) {
+        const auto& pick = to_array_v<Indices>;
+        size_t picked[width + 1] = {};
+        for (size_t i = 0; i < width; ++i) {
+            if (size_t(pick[i]) >= n) lazy_index_out_of_range();
+            picked[i] = idx[pick[i]];
+        }
+        for (size_t i = 0; i < width; ++i) idx[i] = picked[i];
+        n = width;
+    }
+};
+
+template <class Step, class = void>
+struct lazy_width {
+    static constexpr size_t value = 0;
+};
+
+template <class Step>
+struct lazy_width<Step, std::void_t<decltype(Step::width)>> {
+    static constexpr size_t value = Step::width;
+};
+
+// Pred is evaluated once per source element, selected or not
+template <template <class, class> class Pred, class PredParam>
+struct lazy_filter {
+    template <class Src>
+    static constexpr void run(size_t* idx, size_t& n) {
+        const auto& keep = to_array_v<typename lazy_mask<Src, Pred, PredParam>::type>;
+        size_t j = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (keep[idx[i]]) idx[j++] = idx[i];
+        }
+        n = j;
+    }
+};
+
+// operator| is a hidden friend, so ADL finds it through the exported lazy names
+// though detail is not exported
+template <class... Steps>
+struct lazy_expr {
+    template <class... More>
+    friend constexpr lazy_expr<Steps..., More...> operator|(lazy_expr, lazy_expr<More...>) { return {}; }
+};
+
+// Positions of the result in the source - an array constant with a count, for to_seq
+template <class Expr, class _T> struct lazy_indices;
+
+template <class... Steps, class _T>
+struct lazy_indices<lazy_expr<Steps...>, _T> {
+    static constexpr size_t n     = size_v<_T>;
+    static constexpr size_t width = std::max({n, lazy_width<Steps>::value...});
+
+    struct result {
+        std::array<size_t, width> idx{};
+        size_t count = n;
+    };
+
+    static constexpr result r = [] {
+        result x;
+        for (size_t i = 0; i < n; ++i) x.idx[i] = i;
+        (Steps::template run<_T>(x.idx.data(), x.count), ...);
+        return x;
+    }();
+
+    static constexpr std::array<size_t, width> value = r.idx;
+    static constexpr size_t count = r.count;
+};
+
+// Expr may be const - decltype of a single step
+template <class Expr, class _T>
+struct lazy_apply {
+    using indices = to_seq_t<lazy_indices<std::remove_cv_t<Expr>, _T>>;
+    using type    = gather_t<indices, _T>;
+};
+
+template <class Expr, class _T>
+using lazy_apply_t = typename lazy_apply<Expr, _T>::type;
 
 } // namespace detail
 } // namespace t
 
-
+#undef T_DETAIL_TYPE_PACK_ELEMENT
@@ -0,0 +1,142 @@
+#include "type_util.h"
+#include "test_manager.h"
+
+#include <string>
+#include <tuple>
+
+using namespace t;
+
+//
+// tuple
+//
+
+STATIC_EXPECT_SAME((concat_t<
+                       int,
+                       bool, std::tuple<std::string>, std::tuple<>, char,
+                       std::tuple<double>
+                   >),
+                   (std::tuple<int, bool, std::string, char, double>))
+STATIC_EXPECT_SAME((concat_t<std::tuple<int>, std::tuple<>, std::tuple<bool, char>, std::tuple<long>>),
+                   (std::tuple<int, bool, char, long>))
+STATIC_EXPECT_SAME((concat_t<seq_t<int, 1>, int>), (std::tuple<seq_t<int, 1>, int>))
+
+STATIC_EXPECT_SAME((reverse_t<std::tuple<int, bool, std::string, double>>), (std::tuple<double, std::string, bool, int>))
+
+STATIC_EXPECT_SAME((reverse2_t<std::tuple<int, bool, std::string, double>>),
+                   (std::tuple<double, std::string, bool, int>))
+STATIC_EXPECT_SAME((reverse_t<std::tuple<>>), (std::tuple<>))
+
+STATIC_EXPECT_SAME((head_t<2, std::tuple<int, bool, long, double>>), (std::tuple<int, bool>))
+STATIC_EXPECT_SAME((head_t<3, std::tuple<int, bool, long, double>>), (std::tuple<int, bool, long>))
+
+STATIC_EXPECT_SAME((tail_t<2, std::tuple<int, bool, long, double>>), (std::tuple<           long, double>))
+STATIC_EXPECT_SAME((tail_t<3, std::tuple<int, bool, long, double>>), (std::tuple<     bool, long, double>))
+
+STATIC_EXPECT_SAME((skip_t<2, std::tuple<int, bool, long, double>>), (std::tuple<           long, double>))
+STATIC_EXPECT_SAME((skip_t<3, std::tuple<int, bool, long, double>>), (std::tuple<                 double>))
+
+STATIC_EXPECT_SAME((select_t<3, std::tuple<int, bool, long, double>>), (double))
+STATIC_EXPECT_SAME((select_t<2, std::tuple<int, bool, long, double>>), (long))
+
+STATIC_EXPECT_SAME((erase_t<0, std::tuple<int, bool, long, double>>), (std::tuple<bool, long, double>))
+STATIC_EXPECT_SAME((erase_t<2, std::tuple<int, bool, long, double>>), (std::tuple<int, bool, double>))
+
+STATIC_EXPECT_SAME((gather_t<seq_t<size_t, 3, 0, 0>, std::tuple<int, bool, long, double>>),
+                   (std::tuple<double, int, int>))
+STATIC_EXPECT_SAME((gather_t<seq_t<size_t>, std::tuple<int, bool, long, double>>), (std::tuple<>))
+
+//
+// seq
+//
+
+STATIC_EXPECT_SAME((concat_t<seq_t<int, 1,2,3>, seq_t<int, 4,5,6>,seq_t<int, 7,8,9>>),
+                   (seq_t<int, 1,2,3, 4,5,6, 7,8,9>))
+
+STATIC_EXPECT_SAME((head_t<2, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 4, 1>))
+STATIC_EXPECT_SAME((head_t<3, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 4, 1, 8>))
+
+STATIC_EXPECT_SAME((tail_t<2, seq_t<int, 4, 1, 8, 8>>), (seq_t<int,       8, 8>))
+STATIC_EXPECT_SAME((tail_t<3, seq_t<int, 4, 1, 8, 8>>), (seq_t<int,    1, 8, 8>))
+
+STATIC_EXPECT_SAME((skip_t<2, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 8, 8>))
+STATIC_EXPECT_SAME((skip_t<3, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 8>))
+
+STATIC_EXPECT_SAME((select_t<0, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 4>))
+STATIC_EXPECT_SAME((select_t<1, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 1>))
+STATIC_EXPECT_SAME((select_t<2, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 8>))
+STATIC_EXPECT_SAME((select_t<3, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 8>))
+STATIC_EXPECT_EQ((select_v<1, seq_t<int, 4, 1, 8, 8>>), (1))
+
+STATIC_EXPECT_SAME((erase_t<1, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 4, 8, 8>))
+STATIC_EXPECT_SAME((erase_t<3, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 4, 1, 8>))
+
+STATIC_EXPECT_SAME((gather_t<seq_t<size_t, 2, 1, 0>, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 8, 1, 4>))
+
+STATIC_EXPECT_SAME((concat_t<seq_t<int, 1>, seq_t<int>, seq_t<int, 2, 3>, seq_t<int, 4>>),
+                   (seq_t<int, 1, 2, 3, 4>))
+
+STATIC_EXPECT_SAME((filter_t<seq_t<int>, is_one_of, seq_t<int, 1>>), (seq_t<int>))
+
+STATIC_EXPECT_SAME((reverse_t<seq_t<int>>), (seq_t<int>))
+STATIC_EXPECT_SAME((reverse_t<seq_t<int, 4, 1, 24, 8>>),  (seq_t<int, 8, 24, 1, 4>))
+STATIC_EXPECT_SAME((reverse2_t<seq_t<int, 4, 1, 24, 8>>), (seq_t<int, 8, 24, 1, 4>))
+
+//
+// lazy
+//
+
+template <class T, class>
+struct wider_than_1 {
+    static constexpr bool value = sizeof(T) > 1;
+};
+
+using lazy_list = std::tuple<char, int, bool, long, short, double>;
+using lazy_e    = decltype(lazy::skip<1> | lazy::filter<wider_than_1> | lazy::reverse);
+
+STATIC_EXPECT_SAME((lazy::apply_t<lazy_e, lazy_list>),
+                   (reverse_t<filter_t<skip_t<1, lazy_list>, wider_than_1>>))
+STATIC_EXPECT_SAME((lazy::apply_t<lazy_e, lazy_list>), (std::tuple<double, short, long, int>))
+STATIC_EXPECT_SAME((lazy::indices_t<lazy_e, lazy_list>), (seq_t<size_t, 5, 4, 3, 1>))
+
+STATIC_EXPECT_SAME((lazy::apply_t<decltype(lazy::head<4> | lazy::tail<2>), lazy_list>), (std::tuple<bool, long>))
+STATIC_EXPECT_SAME((lazy::apply_t<decltype(lazy::erase<0> | lazy::erase<1>), lazy_list>),
+                   (erase_t<1, erase_t<0, lazy_list>>))
+STATIC_EXPECT_SAME((lazy::apply_t<decltype(lazy::reverse | lazy::gather<seq_t<size_t, 0, 0, 5>>), lazy_list>),
+                   (std::tuple<double, double, char>))
+STATIC_EXPECT_SAME((lazy::apply_t<decltype(lazy::skip<6>), lazy_list>), (std::tuple<>))
+STATIC_EXPECT_SAME((lazy::apply_t<decltype(lazy::reverse), std::tuple<>>), (std::tuple<>))
+
+STATIC_EXPECT_SAME((lazy::apply_t<decltype(lazy::filter<is_not_one_of, seq_t<int, 1, 8>> | lazy::head<2>),
+                                  seq_t<int, 4, 1, 24, 8, 7>>),
+                   (seq_t<int, 4, 24>))
+STATIC_EXPECT_SAME((lazy::apply_t<decltype(lazy::tail<3> | lazy::reverse | lazy::erase<1>), seq_t<int, 4, 1, 24, 8, 7>>),
+                   (seq_t<int, 7, 24>))
+STATIC_EXPECT_SAME((lazy::apply_t<decltype(lazy::gather<seq_t<size_t, 1, 1, 1, 0>> | lazy::skip<2>),
+                                  seq_t<int, 4, 1>>),
+                   (seq_t<int, 1, 4>))
+
+//
+// concat_t of a few thousand arguments - deeper than the default template depth of
+// 900 if concatenation recursed once per argument
+//
+
+template <int I>
+struct many_tag {};
+
+template <class Is> struct many_singles;
+
+template <size_t... Is>
+struct many_singles<std::index_sequence<Is...>> {
+    using tuples = concat_t<std::tuple<many_tag<int(Is)>>...>;
+    using seqs   = concat_t<seq_t<int, int(Is)>...>;
+};
+
+using many = many_singles<std::make_index_sequence<3000>>;
+
+// EQ of is_same_v - a SAME check would print the names of the 3000 element types
+STATIC_EXPECT_EQ((size_v<many::tuples>), (3000))
+STATIC_EXPECT_SAME((select_t<2999, many::tuples>), (many_tag<2999>))
+STATIC_EXPECT_SAME((skip_t<2998, many::tuples>), (std::tuple<many_tag<2998>, many_tag<2999>>))
+STATIC_EXPECT_EQ((std::is_same_v<many::seqs, iota_t<int, 0, 3000>>), (true))
+
+STATIC_TESTS();
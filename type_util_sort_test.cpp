@@ -0,0 +1,108 @@
+#include "type_util.h"
+#include "test_manager.h"
+
+#include <functional>
+#include <string_view>
+#include <tuple>
+
+using namespace t;
+
+// Minimum sizeof(T) in tuple - manual
+
+template <class _T> struct min_sz;
+
+template <class T>
+struct min_sz<std::tuple<T>> {
+    static constexpr int value = sizeof(T);
+    static constexpr int index = 0;
+};
+
+template <class T, class... Ts>
+struct min_sz<std::tuple<T, Ts...>> {
+    using second_type = min_sz<std::tuple<Ts...>>;
+    static constexpr int value = sizeof(T) <= second_type::value ? sizeof(T) : second_type::value;
+    static constexpr int index = sizeof(T) <= second_type::value ? 0 : second_type::index + 1;
+};
+
+template <class _T>
+static constexpr int min_sz_i = min_sz<_T>::index;
+template <class _T>
+static constexpr int min_sz_v = min_sz<_T>::value;
+
+// Minimum sizeof(T) in tuple - simpler
+
+template <class _T> struct min_sz2;
+
+template <class... Ts>
+struct min_sz2<std::tuple<Ts...>> {
+    static constexpr size_t index = t::min<t::seq_t<size_t, sizeof(Ts)...>>::index;
+};
+
+template <class _T>
+using sz_sorted_t = typename t::selection_sort<min_sz2, _T>::type;
+
+
+// Compare by tens only, so stable sorting is observable
+
+struct tens_less {
+    constexpr bool operator()(int a, int b) const { return a / 10 < b / 10; }
+};
+
+//
+// tuple
+//
+
+STATIC_EXPECT_EQ((min_sz_i<std::tuple<bool, int, long, double>>), (0))
+STATIC_EXPECT_EQ((min_sz_i<std::tuple<int, bool, long, double>>), (1))
+STATIC_EXPECT_EQ((min_sz_i<std::tuple<int, long, bool, double>>), (2))
+STATIC_EXPECT_EQ((min_sz_i<std::tuple<int, long, double, bool>>), (3))
+STATIC_EXPECT_EQ((min_sz_v<std::tuple<bool, int, long, double>>), (1))
+STATIC_EXPECT_EQ((min_sz_v<std::tuple<int, bool, long, double>>), (1))
+STATIC_EXPECT_EQ((min_sz_v<std::tuple<int, long, bool, double>>), (1))
+STATIC_EXPECT_EQ((min_sz_v<std::tuple<int, long, double, bool>>), (1))
+
+STATIC_EXPECT_SAME((sz_sorted_t<std::tuple<int, bool, short, double>>),
+                   (std::tuple<bool, short, int, double>))
+STATIC_EXPECT_SAME((sz_sorted_t<std::tuple<long, int, short, char, bool, double>>),
+                   (std::tuple<char, bool, short, int, long, double>))
+
+using sz_sort = sort_by<std::tuple<long, int, short, char, bool, double>, sizeof_key>;
+STATIC_EXPECT_SAME((sz_sort::type), (std::tuple<char, bool, short, int, long, double>))
+STATIC_EXPECT_SAME((sz_sort::permutation), (seq_t<size_t, 3, 4, 2, 1, 0, 5>))
+STATIC_EXPECT_SAME((sz_sort::inverse),     (seq_t<size_t, 4, 3, 2, 0, 1, 5>))
+STATIC_EXPECT_EQ((sz_sort::value[2]), (2))
+STATIC_EXPECT_SAME((sort_by_t<std::tuple<char, double, short>, alignof_key, std::greater<>>),
+                   (std::tuple<double, short, char>))
+STATIC_EXPECT_SAME((sort_by_t<std::tuple<>, sizeof_key>), (std::tuple<>))
+
+//
+// seq
+//
+
+STATIC_EXPECT_SAME((sorted_t<seq_t<int, 4, 1, 2, 8>>), (seq_t<int, 1, 2, 4, 8>))
+STATIC_EXPECT_SAME((sorted_t<seq_t<int, 8, 4, 2, 1, 1, 8>>), (seq_t<int, 1, 1, 2, 4, 8, 8>))
+STATIC_EXPECT_SAME((sorted_t<seq_t<int>>), (seq_t<int>))
+STATIC_EXPECT_SAME((sorted_t<seq_t<int, 4, 1, 2, 8>, std::greater<>>), (seq_t<int, 8, 4, 2, 1>))
+STATIC_EXPECT_SAME((reverse_sorted_t<seq_t<int, 8, 4, 9, 1, 1, 8>>), (seq_t<int, 9, 8, 8, 4, 1, 1>))
+STATIC_EXPECT_SAME((sorted_t<seq_t<int, 31, 12, 30, 11, 2, 10, 1>, tens_less>),
+                   (seq_t<int, 2, 1, 12, 11, 10, 31, 30>))
+
+//
+// canonical
+//
+
+STATIC_EXPECT_EQ((type_name_v<int> == "int"), (true))
+STATIC_EXPECT_EQ((type_id_v<int> == type_id_v<int>), (true))
+STATIC_EXPECT_EQ((type_id_v<int> != type_id_v<unsigned>), (true))
+STATIC_EXPECT_EQ((type_id_v<std::tuple<int, char>> != type_id_v<std::tuple<char, int>>), (true))
+
+STATIC_EXPECT_SAME((canonical_t<std::tuple<int, char>>), (canonical_t<std::tuple<char, int>>))
+STATIC_EXPECT_SAME((canonical_t<std::tuple<double, char, int, char, double>>),
+                   (canonical_t<std::tuple<int, double, char>>))
+STATIC_EXPECT_EQ((size_v<canonical_t<std::tuple<double, char, int, char, double>>>), (3))
+STATIC_EXPECT_SAME((canonical_t<std::tuple<long>>), (std::tuple<long>))
+STATIC_EXPECT_SAME((canonical_t<std::tuple<>>), (std::tuple<>))
+STATIC_EXPECT_SAME((canonical_t<canonical_t<std::tuple<short, bool, float>>>),
+                   (canonical_t<std::tuple<short, bool, float>>))
+
+STATIC_TESTS();
@@ -1,256 +1,900 @@
 #include "type_util.h"
+#include "packed_tuple.h"
+#include "soa_vector.h"
+#include "visit.h"
+#include "seq_search.h"
+#include "network_sort.h"
+#include "type_mask.h"
+#include "pipeline.h"
+#include "serialize.h"
+#include "search_table.h"
+#include "with_value.h"
+#include "static_map.h"
+#include "typed_pool.h"
+#include "message_ring.h"
+#include "test_manager.h"
 
-#include <string.h>
-
-#include <assert.h>
 #include <algorithm>
 #include <type_traits>
 #include <tuple>
 #include <string>
 #include <string_view>
 #include <iostream>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Sort random arrays of every size up to N with network_sort, and compare to std::sort
+
+template <size_t N>
+bool network_sorts(std::mt19937& rng) {
+    bool ok = network_sorts<N - 1>(rng);
+    for (int rep = 0; rep < 100; ++rep) {
+        std::array<int, N> a;
+        for (auto& v : a) v = int(rng() % 20);
+        auto expected = a;
+        std::sort(expected.begin(), expected.end());
+        t::network_sort(a);
+        ok = ok && a == expected;
+    }
+    return ok;
+}
+
+template <>
+bool network_sorts<0>(std::mt19937&) { return true; }
+
+template <size_t N, size_t Lanes, class T>
+bool network_sorts_lanes(std::mt19937& rng) {
+    std::vector<T> data(N * Lanes);
+    for (auto& v : data) v = T(rng() % 100);
+    auto in = data;
+    t::network_sort_lanes<N, Lanes>(data.data());
+    bool ok = true;
+    for (size_t l = 0; l < Lanes; ++l) {
+        std::vector<T> col, expected;
+        for (size_t i = 0; i < N; ++i) {
+            col.push_back(data[i * Lanes + l]);
+            expected.push_back(in[i * Lanes + l]);
+        }
+        std::sort(expected.begin(), expected.end());
+        ok = ok && col == expected;
+    }
+    return ok;
+}
 
-// Minimum sizeof(T) in tuple - manual
+// N distinct empty types, for a type_bitset of more than one word
+template <int I>
+struct mask_tag {};
 
-template <class _T> struct min_sz;
+template <class Is> struct mask_tags;
 
-template <class T>
-struct min_sz<std::tuple<T>> {
-    static constexpr int value = sizeof(T);
-    static constexpr int index = 0;
+template <size_t... Is>
+struct mask_tags<std::index_sequence<Is...>> {
+    using type = std::tuple<mask_tag<int(Is)>...>;
 };
 
-template <class T, class... Ts>
-struct min_sz<std::tuple<T, Ts...>> {
-    using second_type = min_sz<std::tuple<Ts...>>;
-    static constexpr int value = sizeof(T) <= second_type::value ? sizeof(T) : second_type::value;
-    static constexpr int index = sizeof(T) <= second_type::value ? 0 : second_type::index + 1;
+// A soa_vector column whose copies and moves can throw, and which counts live objects
+struct soa_fragile {
+    static inline int live       = 0;
+    static inline int throw_left = -1;    // throw on this copy/move, -1 never
+    int v;
+    explicit soa_fragile(int x) : v(x) { ++live; }
+    soa_fragile(const soa_fragile& o) : v(o.v) { step(); ++live; }
+    soa_fragile(soa_fragile&& o) : v(o.v) { step(); ++live; }
+    ~soa_fragile() { --live; }
+    static void step() {
+        if (throw_left >= 0 && throw_left-- == 0) throw std::runtime_error("soa_fragile");
+    }
 };
 
-template <class _T>
-static constexpr int min_sz_i = min_sz<_T>::index;
-template <class _T>
-static constexpr int min_sz_v = min_sz<_T>::value;
-
-// Minimum sizeof(T) in tuple - simpler
+// Pipeline stages
 
-template <class _T> struct min_sz2;
+struct parse_stage {
+    using input_type  = std::string;
+    using output_type = int;
+    int operator()(const std::string& s) const { return std::stoi(s); }
+};
 
-template <class... Ts>
-struct min_sz2<std::tuple<Ts...>> {
-    static constexpr size_t index = t::min<t::seq_t<size_t, sizeof(Ts)...>>::index;
+struct twice_stage {
+    using input_type  = int;
+    using output_type = int;
+    int operator()(int x) const {
+        if (x == -1) throw std::invalid_argument("twice_stage: -1");
+        return 2 * x;
+    }
 };
 
-template <class _T>
-using sz_sorted_t = typename t::selection_sort<min_sz2, _T>::type;
+struct halve_stage {
+    using input_type  = int;
+    using output_type = double;
+    double operator()(int x) const { return x / 2.0; }
+};
 
+// Blocking, with state - a running sum
+struct sum_stage {
+    using input_type  = double;
+    using output_type = double;
+    static constexpr bool   blocking       = true;
+    static constexpr size_t queue_capacity = 16;
+    double sum = 0;
+    double operator()(double x) { return sum += x; }
+};
 
-template <class T, class>
-struct bigger_than_1 {
-    static constexpr bool value = sizeof(T) > 1;
+struct format_stage {
+    using input_type  = double;
+    using output_type = std::string;
+    static constexpr bool blocking = true;
+    std::string operator()(double x) const { return std::to_string(long(x)); }
 };
 
-////////////////
+// Counts what segment 0 reads, and a blocking stage that fails on 10
+struct count_stage {
+    using input_type  = int;
+    using output_type = int;
+    size_t calls = 0;
+    int operator()(int x) { ++calls; return x; }
+};
 
-class TestManager {
-    static TestManager*& _inst() {
-        static TestManager* inst = nullptr;
-        return inst;
+struct fail_stage {
+    using input_type  = int;
+    using output_type = int;
+    static constexpr bool   blocking       = true;
+    static constexpr size_t queue_capacity = 16;
+    int operator()(int x) const {
+        if (x == 10) throw std::invalid_argument("fail_stage: 10");
+        return x;
     }
+};
 
-public:
-    TestManager() {
-        auto*& inst = _inst();
-        assert(inst == nullptr);
-        inst = this;
-    }
-    ~TestManager() {
-        auto*& inst = _inst();
-        inst = nullptr;
-    }
+// Input of a blocking stage without a default constructor
+struct no_default {
+    explicit no_default(int x) : v(x) {}
+    int v;
+};
 
-    static TestManager& instance() {
-        return *_inst();
-    }
+struct wrap_stage {
+    using input_type  = int;
+    using output_type = no_default;
+    no_default operator()(int x) const { return no_default(x); }
+};
 
-    template <class EXPR, class EXPECTED>
-    void expect_same(const char* filename, int line_num, const char* expression_str) {
-        test_count++;
-        std::cout << format_filename(filename) << ":" << line_num << " ";
-        if (!std::is_same_v<EXPR, EXPECTED>) {
-            fail_count++;
-            std::cout << fail_str() << "\n  " << expression_str        << "\n"
-                      << "Is:\n  "            << type_name<EXPR>()     << "\n"
-                      << "Expected:\n  "      << type_name<EXPECTED>() << "\n\n";
-        } else if (print_ok) {
-            std::cout << pass_str() << "    "
-                      << (print_ok_exp ? expression_str : "") << "\n";
-        }
-    }
+struct unwrap_stage {
+    using input_type  = no_default;
+    using output_type = int;
+    static constexpr bool blocking = true;
+    int operator()(no_default x) const { return x.v + 1; }
+};
 
-    template <class T1, class T2> // EXPRESSION, class EXPECTED>
-    void expect_eq(const char* filename, int line_num, const char* result_str,
-                   const char* expected_str, const T1& result, const T2& expected) {
-        test_count++;
-        std::cout << format_filename(filename) << ":" << line_num << " ";
-        if (result != T1(expected)) {
-            fail_count++;
-            std::cout << fail_str() << "\n  " << result_str   << "\n"
-                      << "Is:\n  "            << result       << "\n"
-                      << "Expected:\n  "      << expected_str
-                      << "  Which is "        << expected     << "\n\n";
-        } else if (print_ok) {
-            std::cout << pass_str() << "    "
-                      << (print_ok_exp ? result_str : "") << "\n";
-        }
-    }
+// Scattered values - too many for a binary tree, too wide for a jump table
+template <class Is> struct scattered;
 
-    int report() {
-        std::cout << "------\n"
-                  << "Total   " << test_count << " tests\n"
-                  << "\033[32mPASSED\033[0m  " << test_count - fail_count << " tests\n";
-        if (fail_count) {
-            std::cout << "\033[31mFAILED\033[0m  " << fail_count << " tests\n";
-        }
-        return fail_count ? 1 : 0;
-    }
+template <size_t... Is>
+struct scattered<std::index_sequence<Is...>> {
+    using type = t::seq_t<int64_t, (int64_t(Is) * 1000003 - 500000000)...>;
+};
 
-    bool print_ok        = true;
-    bool print_ok_exp    = true;
-    bool print_full_path = false;
+// Keys of a static_map - N spread out values, and a few thousand for the two level hash
+template <class Is> struct map_keys;
 
-private:
-    int test_count = 0;
-    int fail_count = 0;
+template <size_t... Is>
+struct map_keys<std::index_sequence<Is...>> {
+    using type = t::seq_t<uint32_t, uint32_t((Is * 2654435761u) ^ 0x5bd1e995u)...>;
+};
 
-    template<class T>
-    std::string_view type_name() {
-        const char* s     = __PRETTY_FUNCTION__;
-        const char* start = strstr(s, "[with T = ") + strlen("[with T = ");
-        const char* end   = strchr(start, ';');
-        return std::string_view(start, end ? end - start : strlen(start) - 1);
-    }
+// Messages of a typed_pool
+struct pool_msg {
+    int64_t id;
+    double  px;
+    int64_t qty[3];
+};
 
-    std::string_view format_filename(const char* filename) {
-        if (print_full_path) return filename;
-        const char* start = strrchr(filename, '/');
-        return start ? start + 1 : filename;
-    }
+struct alignas(64) pool_line {
+    char bytes[64];
+};
 
-    static const char* fail_str() { return "\033[31mFAIL\033[0m"; }
-    static const char* pass_str() { return "\033[32mOK\033[0m"; }
+// Messages of a message_ring
+struct ring_order {
+    int64_t seq;
+    int64_t px;
 };
 
-#define _UNPAREN_(...)  __VA_ARGS__
+struct ring_text {
+    int64_t     seq;
+    std::string text;
+};
 
-#define EXPECT_SAME(EXPR, EXPECTED)                                         \
-    do {                                                                    \
-        TestManager::instance().expect_same<                                \
-            _UNPAREN_ EXPR, _UNPAREN_ EXPECTED>(__FILE__, __LINE__, #EXPR); \
-    } while (false)
+struct ring_wide {
+    int64_t seq;
+    int64_t fill[20];
+};
 
-#define EXPECT_EQ(EXPR, EXPECTED)                                               \
-    do {                                                                        \
-        TestManager::instance().expect_eq(__FILE__, __LINE__, #EXPR, #EXPECTED, \
-            _UNPAREN_ EXPR, _UNPAREN_ EXPECTED);                                \
-    } while (false)
+////////////////
 
 int main() {
     TestManager test_mgr;
+    test_mgr.run_all();
 
     using namespace t;
 
-    EXPECT_EQ((find_if_v<std::tuple<char, int, long>, std::is_same, char>),  (0));
-    EXPECT_EQ((find_if_v<std::tuple<char, int, long>, std::is_same, int>),   (1));
-    EXPECT_EQ((find_if_v<std::tuple<char, int, long>, std::is_same, long>),  (2));
-    EXPECT_EQ((find_if_v<std::tuple<char, int, long>, std::is_same, short>), (3));
+    //
+    // packed_tuple
+    //
 
-    EXPECT_EQ((find_v<std::tuple<char, int, long>, char>),  (0));
-    EXPECT_EQ((find_v<std::tuple<char, int, long>, int>),   (1));
-    EXPECT_EQ((find_v<std::tuple<char, int, long>, long>),  (2));
-    EXPECT_EQ((find_v<std::tuple<char, int, long>, short>), (end_v<std::tuple<char, int, long>>));
+    using packed_t = packed_tuple<char, double, short, int, char>;
+    EXPECT_SAME((packed_t::stored_type), (std::tuple<double, int, short, char, char>));
+    EXPECT_SAME((packed_t::slots), (seq_t<size_t, 3, 0, 2, 1, 4>));
+    EXPECT_EQ((packed_t::packed_bytes), (sizeof(double) + sizeof(int) + sizeof(short) + 2));
+    // 32 byte std::tuple, 16 packed - the same as the struct written by hand
+    struct packed_by_hand { double d; int i; short s; char c0, c4; };
+    static_assert(sizeof(packed_t) == sizeof(packed_by_hand));
+    static_assert(packed_t::bytes_saved == 16);
+
+    packed_t packed('a', 2.5, short(3), 4, 'e');
+    EXPECT_EQ((packed.get<0>()), ('a'));
+    EXPECT_EQ((packed.get<1>()), (2.5));
+    EXPECT_EQ((get<3>(packed)), (4));
+    get<4>(packed) = 'z';
+    auto [c0, d1, s2, i3, c4] = packed;
+    EXPECT_EQ((c4), ('z'));
+    EXPECT_EQ((s2), (3));
+    EXPECT_SAME((decltype(packed.to_tuple())), (std::tuple<char, double, short, int, char>));
+    EXPECT_EQ((std::get<4>(packed.to_tuple())), ('z'));
+
+    constexpr packed_tuple<char, long> packed_c('x', 7L);
+    static_assert(packed_c.get<1>() == 7L && packed_c.get<0>() == 'x');
+
+    packed_tuple<std::string, char> packed_s(std::string("str"), 'c');
+    EXPECT_EQ((get<0>(packed_s)), (std::string("str")));
 
-    EXPECT_EQ((find_one_of_v<std::tuple<char, int, long>, std::tuple<short>>),       (3));
-    EXPECT_EQ((find_one_of_v<std::tuple<char, int, long>, std::tuple<short, int>>),  (1));
-    EXPECT_EQ((find_one_of_v<std::tuple<char, int, long>, std::tuple<short, long>>), (2));
+    //
+    // soa_vector
+    //
 
-    EXPECT_SAME((filter_t<std::tuple<char, int, long>, bigger_than_1>),
-                (std::tuple<int, long>));
+    soa_vector<std::tuple<int, double, std::string>> soa;
+    for (int i = 0; i < 100; ++i) soa.emplace_back(i, i * 0.5, std::to_string(i));
+    soa.push_back({100, 50.0, "100"});
+    EXPECT_EQ((soa.size()), (101));
+    EXPECT_EQ((reinterpret_cast<uintptr_t>(soa.column<1>().data()) % 64), (0));
+    EXPECT_EQ((soa.column<std::string>()[42]), (std::string("42")));
+    EXPECT_EQ((soa.column<double>()[100]), (50.0));
+
+    std::get<0>(soa[3]) = -3;
+    EXPECT_EQ((soa.column<0>()[3]), (-3));
+    EXPECT_EQ((std::get<2>(soa[100])), (std::string("100")));
+
+    auto soa_cols = soa.view<seq_t<size_t, 2, 0>>();
+    EXPECT_SAME((decltype(soa_cols)::tuple_type), (std::tuple<std::string, int>));
+    EXPECT_EQ((soa_cols.column<int>()[5]), (5));
+    EXPECT_EQ((std::get<0>(soa_cols[7])), (std::string("7")));
+
+    const auto soa_copy = soa;
+    soa.pop_back();
+    EXPECT_EQ((soa_copy.size()), (101));
+    EXPECT_EQ((std::get<0>(soa_copy[3])), (-3));
+    EXPECT_SAME((decltype(soa_copy.view<seq_t<size_t, 1>>().column<0>()[0])), (const double&));
+    double soa_sum = 0;
+    for (double d : soa_copy.column<1>()) soa_sum += d;
+    EXPECT_EQ((soa_sum), (2525.0));
+
+    {
+        soa_vector<std::tuple<std::string, soa_fragile>> fragile;
+        for (int i = 0; i < 16; ++i) fragile.emplace_back(std::to_string(i), i);
+        soa_fragile::throw_left = 5;
+        bool copy_threw = false;
+        try {
+            auto fragile_copy = fragile;
+        } catch (const std::runtime_error&) {
+            copy_threw = true;
+        }
+        EXPECT_EQ((copy_threw), (true));
+        EXPECT_EQ((soa_fragile::live), (16));
+
+        // Growing past 16 relocates - a throwing move falls back to copies, so a
+        // failure leaves the old rows in place
+        soa_fragile::throw_left = 9;
+        bool grow_threw = false;
+        try {
+            fragile.emplace_back("16", 16);
+        } catch (const std::runtime_error&) {
+            grow_threw = true;
+        }
+        soa_fragile::throw_left = -1;
+        EXPECT_EQ((grow_threw), (true));
+        EXPECT_EQ((fragile.size()), (16));
+        EXPECT_EQ((soa_fragile::live), (16));
+        EXPECT_EQ((fragile.column<1>()[15].v), (15));
+        fragile.emplace_back("16", 16);
+        EXPECT_EQ((fragile.size()), (17));
+        EXPECT_EQ((std::get<0>(fragile[9])), (std::string("9")));
+    }
+    EXPECT_EQ((soa_fragile::live), (0));
 
-    EXPECT_SAME((filter_t<seq_t<int, 1, 2, 3, 5, 6, 7>, is_not_one_of, seq_t<int, 2, 3, 4>>),
-                (seq_t<int, 1, 5, 6, 7>));
+    // A row of the vector itself, at full capacity - built before the old columns go
+    soa_vector<std::tuple<std::string, int>> soa_self;
+    for (int i = 0; i < 16; ++i) soa_self.emplace_back(std::string(40, char('a' + i)), i);
+    EXPECT_EQ((soa_self.size() == soa_self.capacity()), (true));
+    soa_self.emplace_back(std::get<0>(soa_self[3]), std::get<1>(soa_self[3]));
+    EXPECT_EQ((std::get<0>(soa_self[16])), (std::string(40, 'd')));
+    EXPECT_EQ((std::get<1>(soa_self[16])), (3));
 
     //
-    // tuple
+    // visit_index / variant_of
     //
 
-    EXPECT_SAME((concat_t<
-                    int,
-                    bool, std::tuple<std::string>, std::tuple<>, char,
-                    std::tuple<double>
-                >),
-                (std::tuple<int, bool, std::string, char, double>));
+    using visit_list = std::tuple<char, int, double, std::string>;
+    auto sizeof_tag = [](auto tag) { return sizeof(typename decltype(tag)::type); };
+    EXPECT_EQ((visit_index<visit_list>(0, sizeof_tag)), (sizeof(char)));
+    EXPECT_EQ((visit_index<visit_list>(2, sizeof_tag)), (sizeof(double)));
+    EXPECT_EQ((visit_index<visit_list>(3, sizeof_tag)), (sizeof(std::string)));
+    EXPECT_EQ((visit_index<visit_list>(4, sizeof_tag, [](size_t) { return size_t(0); })), (0));
+
+    bool visit_threw = false;
+    try {
+        visit_index<visit_list>(size_t(-1), sizeof_tag);
+    } catch (const std::out_of_range&) {
+        visit_threw = true;
+    }
+    EXPECT_EQ((visit_threw), (true));
+
+    size_t visit_bad = 0;
+    visit_index<visit_list>(7, [](auto) {}, [&](size_t i) { visit_bad = i; });
+    EXPECT_EQ((visit_bad), (7));
+
+    using var_t = variant_of<visit_list>;
+    EXPECT_SAME((var_t::index_type), (uint8_t));
+    EXPECT_SAME((uint_for_t<256>), (uint16_t));
+    EXPECT_EQ((sizeof(var_t)), (sizeof(std::string) + alignof(std::string)));
+
+    var_t var;
+    EXPECT_EQ((var.index()), (0));
+    var = std::string("text");
+    EXPECT_EQ((var.holds<std::string>()), (true));
+    var_t var_copy = var;
+    var.emplace<int>(42);
+    EXPECT_EQ((*var.get_if<int>()), (42));
+    EXPECT_EQ((var.get_if<char>() == nullptr), (true));
+    EXPECT_EQ((*var_copy.get_if<std::string>()), (std::string("text")));
+    EXPECT_EQ((var_copy.visit([](const auto& v) { return sizeof(v); })), (sizeof(std::string)));
 
+    //
+    // seq_search
+    //
 
-    EXPECT_SAME((reverse_t<std::tuple<int, bool, std::string, double>>), (std::tuple<double, std::string, bool, int>));
+    using small_seq  = seq_t<int, 7, -3, 12>;
+    using dense_seq  = seq_t<short, 100, 140, 101, 900, 333, 140, 250, 512, 600, 777>;
+    using sparse_seq = seq_t<int, 5, 1000000, -70000, 42, 9999, 123456, 77, 31, 8, 65536, 1 << 30, -1>;
+    using wide_seq   = seq_t<uint64_t, 1, 1ull << 40, 3, 1ull << 63, 5, 6, 7, 8, 9, 10>;
+    using narrow_seq = seq_t<short, -1, 5, -40, 17, 80, 3, -9, 60, 11, 29>;
+    using bytes_seq  = seq_t<signed char, -100, 5, 127, -1, 0, 64, -128, 33, 9, 2>;
+
+    EXPECT_EQ((seq_search_v<small_seq>  == seq_search_kind::unrolled), (true));
+    EXPECT_EQ((seq_search_v<dense_seq>  == seq_search_kind::bitmap),   (true));
+    EXPECT_EQ((seq_search_v<sparse_seq> != seq_search_kind::bitmap),   (true));
+    EXPECT_EQ((seq_search_v<wide_seq>   != seq_search_kind::bitmap),   (true));
+    EXPECT_EQ((seq_search_v<narrow_seq> == seq_search_kind::bitmap),   (true));
+    EXPECT_EQ((seq_search_v<bytes_seq>  == seq_search_kind::bitmap),   (true));
+    EXPECT_EQ((index_of<narrow_seq>(-40)),             (2));
+    EXPECT_EQ((contains<narrow_seq>(-2)),              (false));
+    EXPECT_EQ((index_of<bytes_seq>((signed char)-128)), (6));
+
+    EXPECT_EQ((contains<small_seq>(-3)), (true));
+    EXPECT_EQ((contains<small_seq>(3)),  (false));
+    EXPECT_EQ((index_of<small_seq>(12)), (2));
+    EXPECT_EQ((index_of<small_seq>(0)),  (3));
+
+    EXPECT_EQ((contains<dense_seq>(777)), (true));
+    EXPECT_EQ((contains<dense_seq>(99)),  (false));
+    EXPECT_EQ((contains<dense_seq>(-1)),  (false));
+    EXPECT_EQ((index_of<dense_seq>(140)), (1));
+    EXPECT_EQ((index_of<dense_seq>(901)), (10));
+
+    EXPECT_EQ((contains<sparse_seq>(65536)),  (true));
+    EXPECT_EQ((contains<sparse_seq>(65537)),  (false));
+    EXPECT_EQ((index_of<sparse_seq>(-1)),     (11));
+    EXPECT_EQ((index_of<sparse_seq>(5)),      (0));
+    EXPECT_EQ((index_of<sparse_seq>(6)),      (12));
+    EXPECT_EQ((index_of<wide_seq>(1ull << 63)), (3));
+    EXPECT_EQ((contains<wide_seq>(2)),          (false));
+
+    constexpr auto sparse_a = seq_v<int, 5, 1000000, -70000, 42, 9999, 123456, 77, 31, 8, 65536, 1 << 30, -1>;
+    for (int v : {5, 1000000, -70000, 31, -1, 0, 6, 1 << 29}) {
+        size_t expected = std::find(sparse_a.begin(), sparse_a.end(), v) - sparse_a.begin();
+        EXPECT_EQ((index_of<sparse_seq, seq_search_kind::simd>(v)),     (expected));
+        EXPECT_EQ((index_of<sparse_seq, seq_search_kind::scalar>(v)),   (expected));
+        EXPECT_EQ((contains<sparse_seq, seq_search_kind::simd>(v)),     (expected != 12));
+        EXPECT_EQ((index_of<seq_t<char, 1, 2, 3>, seq_search_kind::simd>(char(v))),
+                  (v >= 1 && v <= 3 ? size_t(v - 1) : 3));
+    }
+
+    //
+    // network_sort
+    //
+
+    EXPECT_SAME((sorting_network_t<4>), (seq_t<size_t, 0, 1, 2, 3, 0, 2, 1, 3, 1, 2>));
+    EXPECT_EQ((sorting_network_size_v<1>), (0));
+    EXPECT_EQ((sorting_network_size_v<8>), (19));
+    EXPECT_EQ((sorting_network_size_v<16>), (63));
+
+    std::mt19937 net_rng(1);
+    EXPECT_EQ((network_sorts<32>(net_rng)), (true));
 
-//    EXPECT_SAME((reverse2_t<std::tuple<int, bool, std::string, double>>,
-//                                            std::tuple<double, std::string, bool, int>>);
+    std::array<double, 5> net_d = {3.5, -1.0, 2.0, 9.0, 0.5};
+    network_sort(net_d, std::greater<>());
+    EXPECT_EQ((net_d == std::array<double, 5>{9.0, 3.5, 2.0, 0.5, -1.0}), (true));
 
-    EXPECT_SAME((head_t<2, std::tuple<int, bool, long, double>>), (std::tuple<int, bool>));
-    EXPECT_SAME((head_t<3, std::tuple<int, bool, long, double>>), (std::tuple<int, bool, long>));
+    EXPECT_EQ((network_sorts_lanes<12, 8, float>(net_rng)), (true));
+    EXPECT_EQ((network_sorts_lanes<16, 16, int32_t>(net_rng)), (true));
+    EXPECT_EQ((network_sorts_lanes<7, 3, long>(net_rng)), (true));
 
-    EXPECT_SAME((tail_t<2, std::tuple<int, bool, long, double>>), (std::tuple<           long, double>));
-    EXPECT_SAME((tail_t<3, std::tuple<int, bool, long, double>>), (std::tuple<     bool, long, double>));
+    //
+    // type_mask
+    //
 
-    EXPECT_SAME((skip_t<2, std::tuple<int, bool, long, double>>), (std::tuple<           long, double>));
-    EXPECT_SAME((skip_t<3, std::tuple<int, bool, long, double>>), (std::tuple<                 double>));
+    using mask_u = std::tuple<char, int, double, std::string, long>;
+    using mask_t = type_bitset<mask_u>;
+    constexpr auto mask_ac = type_mask_v<mask_u, std::tuple<char, double>>;
+    static_assert(mask_t::words == 1 && sizeof(mask_t) == sizeof(uint64_t));
+    static_assert(mask_ac.word(0) == 0b101 && mask_ac.count() == 2);
+    static_assert((~mask_ac).word(0) == 0b11010);
+
+    mask_t mask_rec = mask_t::of<char, int, double>();
+    EXPECT_EQ((mask_rec.includes(mask_ac)), (true));
+    EXPECT_EQ((mask_rec.includes(type_mask_v<mask_u, std::tuple<long>>)), (false));
+    EXPECT_EQ((mask_rec.intersects(type_mask_v<mask_u, std::tuple<long, int>>)), (true));
+    EXPECT_EQ((mask_rec.count()), (3));
+    mask_rec.reset<char>().set<long>();
+    EXPECT_EQ((mask_rec.test<char>()), (false));
+    EXPECT_EQ((mask_rec.includes(mask_ac)), (false));
+    EXPECT_EQ((mask_rec == mask_t::of<int, double, long>()), (true));
+    EXPECT_EQ(((mask_rec & mask_ac) == mask_t::of<double>()), (true));
+    EXPECT_EQ(((mask_rec | ~mask_rec).count()), (5));
+    EXPECT_EQ((mask_t().none()), (true));
+
+    using wide_u = mask_tags<std::make_index_sequence<130>>::type;
+    using wide_t = type_bitset<wide_u>;
+    constexpr auto wide_q = type_mask_v<wide_u, std::tuple<mask_tag<1>, mask_tag<64>, mask_tag<129>>>;
+    static_assert(wide_t::words == 3);
+    static_assert(wide_q.word(0) == 2 && wide_q.word(1) == 1 && wide_q.word(2) == 2);
+    static_assert((~wide_t()).count() == 130);
+
+    wide_t wide_rec = wide_q;
+    EXPECT_EQ((wide_rec.includes(wide_q)), (true));
+    wide_rec.reset<mask_tag<64>>();
+    EXPECT_EQ((wide_rec.includes(wide_q)), (false));
+    EXPECT_EQ((wide_rec.intersects(wide_q)), (true));
+    EXPECT_EQ((wide_rec.intersects(wide_t::of<mask_tag<64>, mask_tag<100>>())), (false));
+    EXPECT_EQ((wide_rec.count()), (2));
+    EXPECT_EQ(((~wide_rec).count()), (128));
 
-    EXPECT_SAME((select_t<3, std::tuple<int, bool, long, double>>), (double));
-    EXPECT_SAME((select_t<2, std::tuple<int, bool, long, double>>), (long));
+    //
+    // pipeline
+    //
 
-    EXPECT_EQ((min_sz_i<std::tuple<bool, int, long, double>>), (0));
-    EXPECT_EQ((min_sz_i<std::tuple<int, bool, long, double>>), (1));
-    EXPECT_EQ((min_sz_i<std::tuple<int, long, bool, double>>), (2));
-    EXPECT_EQ((min_sz_i<std::tuple<int, long, double, bool>>), (3));
-    EXPECT_EQ((min_sz_v<std::tuple<bool, int, long, double>>), (1));
-    EXPECT_EQ((min_sz_v<std::tuple<int, bool, long, double>>), (1));
-    EXPECT_EQ((min_sz_v<std::tuple<int, long, bool, double>>), (1));
-    EXPECT_EQ((min_sz_v<std::tuple<int, long, double, bool>>), (1));
+    using fused_p = pipeline<parse_stage, twice_stage, halve_stage>;
+    EXPECT_EQ((fused_p::segment_count), (1));
+    EXPECT_SAME((fused_p::input_type), (std::string));
+    EXPECT_SAME((fused_p::output_type), (double));
+    EXPECT_EQ((detail::pipeline_links<std::tuple<parse_stage, halve_stage, twice_stage>>::first_bad), (1));
+    fused_p fused;
+    EXPECT_EQ((fused("21")), (21.0));
+
+    std::vector<std::string> pipe_in;
+    for (int i = 0; i < 5000; ++i) pipe_in.push_back(std::to_string(i));
+    std::vector<double> pipe_out;
+    fused.run(pipe_in.begin(), pipe_in.end(), std::back_inserter(pipe_out));
+    EXPECT_EQ((pipe_out.size()), (5000));
+    EXPECT_EQ((pipe_out[4999]), (4999.0));
+
+    using threaded_p = pipeline<parse_stage, twice_stage, halve_stage, sum_stage, format_stage>;
+    EXPECT_EQ((threaded_p::segment_count), (3));
+    EXPECT_SAME((threaded_p::segment_of), (seq_t<int, 0, 0, 0, 1, 2>));
+    threaded_p threaded;
+    std::vector<std::string> pipe_str;
+    threaded.run(pipe_in.begin(), pipe_in.end(), std::back_inserter(pipe_str));
+    EXPECT_EQ((pipe_str.size()), (5000));
+    EXPECT_EQ((pipe_str[3]), (std::string("6")));
+    EXPECT_EQ((pipe_str[4999]), (std::to_string(4999L * 5000 / 2)));
+    EXPECT_EQ((threaded.stage<3>().sum), (4999.0 * 5000 / 2));
+
+    // Blocking first stage - segment 0 is empty
+    using first_blocking_p = pipeline<sum_stage, format_stage>;
+    EXPECT_EQ((first_blocking_p::segment_count), (3));
+    std::vector<double> pipe_d = {1, 2, 3};
+    std::vector<std::string> pipe_fb;
+    first_blocking_p().run(pipe_d.begin(), pipe_d.end(), std::back_inserter(pipe_fb));
+    EXPECT_EQ((pipe_fb == std::vector<std::string>{"1", "3", "6"}), (true));
+
+    pipe_in[2500] = "-1";
+    bool pipe_threw = false;
+    try {
+        threaded_p().run(pipe_in.begin(), pipe_in.end(), std::back_inserter(pipe_str));
+    } catch (const std::invalid_argument&) {
+        pipe_threw = true;
+    }
+    EXPECT_EQ((pipe_threw), (true));
+
+    // A worker's exception stops segment 0 reading input, within a queue or so
+    pipeline<count_stage, fail_stage> failing;
+    std::vector<int> pipe_ints(100000), pipe_ints_out;
+    std::iota(pipe_ints.begin(), pipe_ints.end(), 0);
+    pipe_threw = false;
+    try {
+        failing.run(pipe_ints.begin(), pipe_ints.end(), std::back_inserter(pipe_ints_out));
+    } catch (const std::invalid_argument&) {
+        pipe_threw = true;
+    }
+    EXPECT_EQ((pipe_threw), (true));
+    EXPECT_EQ((failing.stage<0>().calls < pipe_ints.size()), (true));
 
+    std::vector<int> pipe_wrapped;
+    pipeline<wrap_stage, unwrap_stage>().run(pipe_ints.begin(), pipe_ints.begin() + 100,
+                                             std::back_inserter(pipe_wrapped));
+    EXPECT_EQ((pipe_wrapped.size()), (100));
+    EXPECT_EQ((pipe_wrapped[99]), (100));
+
+    //
+    // serialize / wire_view
+    //
+
+    using quote_t = std::tuple<int64_t, double, uint16_t, char>;
+    using quote_ser = serialize<quote_t>;
+    EXPECT_EQ((quote_ser::fixed_bytes), (8 + 8 + 2 + 1));
+    EXPECT_EQ((quote_ser::layout::fields[0].run), (19));
+    EXPECT_EQ((quote_ser::layout::fields[3].last), (true));
+
+    quote_t quote{1234567890123, 101.25, 300, 'B'};
+    auto quote_bytes = quote_ser::to_bytes(quote);
+    EXPECT_EQ((quote_bytes.size()), (19));
+    quote_t quote_back{};
+    EXPECT_EQ((quote_ser::read(quote_bytes.data(), quote_bytes.data() + 19, quote_back)
+               == quote_bytes.data() + 19), (true));
+    EXPECT_EQ((quote_back == quote), (true));
+    EXPECT_EQ((quote_ser::read(quote_bytes.data(), quote_bytes.data() + 18, quote_back)), (nullptr));
+
+    wire_view<quote_t> quote_view(quote_bytes.data(), quote_bytes.size());
+    EXPECT_EQ((wire_view<quote_t>::offset_v<2>), (16));
+    EXPECT_EQ((quote_view.get<1>()), (101.25));
+    EXPECT_EQ((get<3>(quote_view)), ('B'));
+    auto [qv_px, qv_vol, qv_qty, qv_side] = quote_view;
+    EXPECT_EQ((qv_px), (1234567890123));
+    EXPECT_EQ((qv_qty), (300));
+    EXPECT_EQ((quote_view.to_tuple() == quote), (true));
+
+    bool wire_threw = false;
+    try {
+        wire_view<quote_t> short_view(quote_bytes.data(), quote_bytes.size() - 1);
+    } catch (const std::out_of_range&) {
+        wire_threw = true;
+    }
+    EXPECT_EQ((wire_threw), (true));
+
+    // Runs split by variable fields
+    using order_t = std::tuple<int, char, std::string, double, std::string, short>;
+    using order_ser = serialize<order_t>;
+    EXPECT_SAME((order_ser::fixed_fields), (std::tuple<int, char, double, short>));
+    EXPECT_SAME((order_ser::variable_fields), (std::tuple<std::string, std::string>));
+    EXPECT_EQ((order_ser::layout::fields[0].run), (5));
+    EXPECT_EQ((order_ser::layout::fields[1].offset), (4));
+    EXPECT_EQ((order_ser::layout::fields[3].run), (8));
+
+    order_t order{7, 'x', "ACME", 2.5, std::string(300, 'z'), -4};
+    auto order_bytes = order_ser::to_bytes(order);
+    EXPECT_EQ((order_bytes.size()), (order_ser::fixed_bytes + 4 + 4 + 4 + 300));
+    order_t order_back{};
+    EXPECT_EQ((order_ser::read(order_bytes.data(), order_bytes.data() + order_bytes.size(), order_back)
+               == order_bytes.data() + order_bytes.size()), (true));
+    EXPECT_EQ((order_back == order), (true));
+    for (size_t cut : {0, 4, 5, 10, 20, 300}) {
+        EXPECT_EQ((order_ser::read(order_bytes.data(), order_bytes.data() + cut, order_back)), (nullptr));
+    }
+
+    //
+    // search_table
+    //
+
+    using tier_seq = sorted_t<seq_t<int, 500, -20, 0, 1000, 10000, 7, 7, 7, 250000, 99, 3, 1 << 30>>;
+    using tiers    = search_table<tier_seq>;
+    constexpr auto& tier_a = to_array_v<tier_seq>;
+    EXPECT_EQ((tiers::layout[1]), (tier_a[7]));
+    EXPECT_EQ((tiers::index[0]), (12));
+    for (int v : {-21, -20, -19, 0, 3, 6, 7, 8, 99, 100, 500, 10000, 250001, 1 << 30, (1 << 30) + 1}) {
+        EXPECT_EQ((tiers::lower_bound(v) == std::lower_bound(tier_a.begin(), tier_a.end(), v)), (true));
+        EXPECT_EQ((tiers::upper_bound(v) == std::upper_bound(tier_a.begin(), tier_a.end(), v)), (true));
+        EXPECT_EQ((tiers::rank(v)), (size_t(std::lower_bound(tier_a.begin(), tier_a.end(), v) - tier_a.begin())));
+    }
 
-    EXPECT_SAME((sz_sorted_t<std::tuple<int, bool, short, double>>),
-                (std::tuple<bool, short, int, double>));
-    EXPECT_SAME((sz_sorted_t<std::tuple<long, int, short, char, bool, double>>),
-                (std::tuple<char, bool, short, int, long, double>));
+    // Every size up to past a full tree, every gap and every constant
+    using odd_seq  = iota_t<int, 1, 61, 2>;
+    constexpr auto& odd_a = to_array_v<odd_seq>;
+    bool odd_ok = true;
+    for (int v = 0; v <= 61; ++v) {
+        odd_ok = odd_ok && search_table<odd_seq>::rank(v) == size_t(v / 2)
+                        && search_table<head_t<15, odd_seq>>::rank(v) == std::min(size_t(v / 2), size_t(15))
+                        && search_table<head_t<16, odd_seq>>::upper_bound(v)
+                               - to_array_v<head_t<16, odd_seq>>.data()
+                               == std::upper_bound(odd_a.begin(), odd_a.begin() + 16, v) - odd_a.begin();
+    }
+    EXPECT_EQ((odd_ok), (true));
+    EXPECT_EQ((search_table<seq_t<int>>::rank(5)), (0));
+    EXPECT_EQ((search_table<seq_t<unsigned char, 4>>::upper_bound(4)
+               == to_array_v<seq_t<unsigned char, 4>>.data() + 1), (true));
 
     //
-    // seq
+    // with_value
     //
 
-    EXPECT_SAME((concat_t<seq_t<int, 1,2,3>, seq_t<int, 4,5,6>,seq_t<int, 7,8,9>>),
-                (seq_t<int, 1,2,3, 4,5,6, 7,8,9>));
+    using width_seq   = seq_t<int, 8, 1, 2, 4, 2>;
+    using scale_seq   = seq_t<int, -1000, 7, 1 << 20, 3, 90000>;
+    using scatter_seq = scattered<std::make_index_sequence<100>>::type;
+    constexpr auto& scatter_a = to_array_v<scatter_seq>;
+
+    EXPECT_EQ((value_dispatch_v<width_seq>   == value_dispatch::jump_table),   (true));
+    EXPECT_EQ((value_dispatch_v<scale_seq>   == value_dispatch::binary_tree),  (true));
+    EXPECT_EQ((value_dispatch_v<scatter_seq> == value_dispatch::perfect_hash), (true));
+
+    auto times10 = [](auto v) { return int64_t(v.value) * 10; };
+    auto minus1  = [](auto) { return int64_t(-1); };
+    EXPECT_EQ((with_value<width_seq>(4, times10)), (40));
+    EXPECT_EQ((with_value<width_seq>(3, times10, minus1)), (-1));
+    EXPECT_EQ((with_value<width_seq>(9, times10, minus1)), (-1));
+    EXPECT_EQ((with_value<width_seq>(-8, times10, minus1)), (-1));
+    EXPECT_EQ((with_value<scale_seq>(90000, times10)), (900000));
+    EXPECT_EQ((with_value<scale_seq>(-1000, times10)), (-10000));
+    EXPECT_EQ((with_value<scale_seq>(8, times10, minus1)), (-1));
+    EXPECT_EQ((with_value<scale_seq, value_dispatch::binary_tree>(1 << 20, times10)), (10 << 20));
+    EXPECT_EQ((with_value<width_seq, value_dispatch::binary_tree>(5, times10, minus1)), (-1));
+
+    // Every value and every value next to one, through each dispatch that applies
+    bool scatter_ok = true;
+    for (int64_t v : scatter_a) {
+        for (int64_t x : {v - 1, v, v + 1}) {
+            int64_t expected = x == v ? x * 10 : -1;
+            scatter_ok = scatter_ok
+                && with_value<scatter_seq>(x, times10, minus1) == expected
+                && with_value<scatter_seq, value_dispatch::binary_tree>(x, times10, minus1) == expected;
+        }
+    }
+    EXPECT_EQ((scatter_ok), (true));
+    EXPECT_EQ((with_value<scatter_seq>(INT64_MIN, times10, minus1)), (-1));
 
+    // The value arrives as a constant
+    EXPECT_EQ((with_value<width_seq>(8, [](auto w) { return std::array<char, w.value>().size(); })), (8));
 
-    EXPECT_SAME((head_t<2, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 4, 1>));
-    EXPECT_SAME((head_t<3, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 4, 1, 8>));
+    bool value_threw = false;
+    try {
+        with_value<scale_seq>(0, times10);
+    } catch (const std::out_of_range&) {
+        value_threw = true;
+    }
+    EXPECT_EQ((value_threw), (true));
+
+    // A void handler that returns, where a value is expected, is followed by the throw
+    int value_missed = 0;
+    value_threw = false;
+    try {
+        with_value<scatter_seq>(5, times10, [&](int64_t x) { value_missed = int(x); });
+    } catch (const std::out_of_range&) {
+        value_threw = true;
+    }
+    EXPECT_EQ((value_missed), (5));
+    EXPECT_EQ((value_threw), (true));
 
-    EXPECT_SAME((tail_t<2, seq_t<int, 4, 1, 8, 8>>), (seq_t<int,       8, 8>));
-    EXPECT_SAME((tail_t<3, seq_t<int, 4, 1, 8, 8>>), (seq_t<int,    1, 8, 8>));
+    //
+    // static_map
+    //
 
-    EXPECT_SAME((skip_t<2, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 8, 8>));
-    EXPECT_SAME((skip_t<3, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 8>));
+    using tag_map = static_map<seq_t<char, 'A', 'D', 'E', 'X', 'U', 'P'>, std::string>;
+    tag_map tags{"add", "delete", "execute", "cancel", "replace", "trade"};
+    EXPECT_EQ((tag_map::size), (6));
+    EXPECT_EQ((tag_map::index_of('X')), (3));
+    EXPECT_EQ((tag_map::index_of('B')), (6));
+    EXPECT_EQ((tag_map::contains('P')), (true));
+    EXPECT_EQ((tag_map::contains('\0')), (false));
+    EXPECT_EQ((*tags.find('E')), (std::string("execute")));
+    EXPECT_EQ((tags.find('Q') == nullptr), (true));
+    EXPECT_EQ((tags.get<'U'>()), (std::string("replace")));
+    tags.at('D') = "remove";
+    EXPECT_EQ((tags.values()[1]), (std::string("remove")));
+
+    bool map_threw = false;
+    try {
+        tags.at('Z');
+    } catch (const std::out_of_range&) {
+        map_threw = true;
+    }
+    EXPECT_EQ((map_threw), (true));
+
+    // One multiply for a few hundred keys, the seeded hash for thousands
+    using keys_300  = map_keys<std::make_index_sequence<300>>::type;
+    using keys_3000 = map_keys<std::make_index_sequence<3000>>::type;
+    EXPECT_EQ((detail::static_map_table<keys_300>::one_multiply),  (true));
+    EXPECT_EQ((detail::static_map_table<keys_3000>::one_multiply), (false));
+
+    static_map<keys_300, int> map_300;
+    for (size_t i = 0; i < map_300.size; ++i) map_300.values()[i] = int(i);
+    static_map<keys_3000, int> map_3000;
+    bool map_ok = true;
+    for (size_t i = 0; i < map_300.size; ++i) {
+        uint32_t k = map_300.keys[i];
+        map_ok = map_ok && map_300.at(k) == int(i) && !map_300.contains(k + 1) && !map_300.contains(k - 1);
+    }
+    for (size_t i = 0; i < map_3000.size; ++i) {
+        uint32_t k = map_3000.keys[i];
+        map_ok = map_ok && map_3000.index_of(k) == i && map_3000.find(k + 1) == nullptr;
+    }
+    EXPECT_EQ((map_ok), (true));
+    EXPECT_EQ((static_map<seq_t<int>, int>::contains(0)), (false));
+    EXPECT_EQ((static_map<seq_t<int, -5>, int>(7).at(-5)), (7));
 
-    EXPECT_SAME((select_t<0, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 4>));
-    EXPECT_SAME((select_t<1, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 1>));
-    EXPECT_SAME((select_t<2, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 8>));
-    EXPECT_SAME((select_t<3, seq_t<int, 4, 1, 8, 8>>), (seq_t<int, 8>));
+    //
+    // typed_pool
+    //
 
-//    EXPECT_SAME((reverse_t<seq_t<int, 4, 1, 24, 8>>),  (seq_t<int, 8, 24, 1, 4>));
-//    EXPECT_SAME((reverse2_t<seq_t<int, 4, 1, 24, 8>>), (seq_t<int, 8, 24, 1, 4>));
+    using pool_types = std::tuple<char, int, double, std::string, pool_msg, pool_line>;
+    using msg_pool   = typed_pool<pool_types>;
+    EXPECT_EQ((msg_pool::class_count), (4));
+    EXPECT_EQ((msg_pool::class_of<char>()), (0));
+    EXPECT_EQ((msg_pool::class_of<double>()), (0));
+    EXPECT_EQ((msg_pool::class_of<pool_msg>()), (2));
+    EXPECT_EQ((msg_pool::block_size(msg_pool::class_of<pool_msg>())), (40));
+    EXPECT_EQ((msg_pool::block_align(msg_pool::class_of<pool_line>())), (64));
+
+    msg_pool pool;
+    std::string* pooled_str = pool.create<std::string>(100, 'x');
+    EXPECT_EQ((pooled_str->size()), (100));
+    pool.destroy(pooled_str);
+    EXPECT_EQ((pool.create<std::string>("again") == pooled_str), (true));
+    EXPECT_EQ((*pooled_str), (std::string("again")));
+    pool.destroy(pooled_str);
+
+    // Blocks of one class are shared by its types, freed ones first
+    int* pooled_int = pool.allocate<int>();
+    pool.deallocate(pooled_int);
+    EXPECT_EQ((static_cast<void*>(pool.allocate<double>()) == static_cast<void*>(pooled_int)), (true));
+
+    std::vector<pool_line*> lines;
+    for (int i = 0; i < 1500; ++i) lines.push_back(pool.create<pool_line>());
+    bool lines_aligned = true;
+    for (pool_line* l : lines) lines_aligned = lines_aligned && reinterpret_cast<uintptr_t>(l) % 64 == 0;
+    EXPECT_EQ((lines_aligned), (true));
+    for (size_t i = 0; i < 1000; ++i) pool.destroy(lines[i]);
+    auto line_stats = pool.stats<pool_line>();
+    EXPECT_EQ((line_stats.out), (500));
+    EXPECT_EQ((line_stats.high_water), (1500));
+    EXPECT_EQ((line_stats.slabs), (2));
+    EXPECT_EQ((line_stats.allocations), (1500));
+    EXPECT_EQ((pool.stats(0).out), (1));
+
+    // Threads through their own caches - all blocks back in the pool at the end
+    using shared_pool = typed_pool<pool_types, pool_mode::shared>;
+    shared_pool spool;
+    std::vector<std::thread> pool_threads;
+    for (int th = 0; th < 4; ++th) {
+        pool_threads.emplace_back([&spool, th] {
+            shared_pool::cache cache(spool);
+            std::vector<pool_msg*> live;
+            for (int i = 0; i < 20000; ++i) {
+                live.push_back(cache.create<pool_msg>(pool_msg{i, 1.5, {th, 0, 0}}));
+                if (i % 3 != 0) {
+                    cache.destroy(live.back());
+                    live.pop_back();
+                }
+                if (live.size() > 300) {
+                    for (pool_msg* m : live) cache.destroy(m);
+                    live.clear();
+                }
+                cache.destroy(cache.create<std::string>("short lived"));
+            }
+            for (pool_msg* m : live) cache.destroy(m);
+        });
+    }
+    for (auto& th : pool_threads) th.join();
+    auto msg_stats = spool.stats<pool_msg>();
+    EXPECT_EQ((msg_stats.out), (0));
+    EXPECT_EQ((msg_stats.high_water >= 4 && msg_stats.high_water <= 4 * (301 + 2 * shared_pool::cache::batch(2))), (true));
+    EXPECT_EQ((spool.stats<std::string>().out), (0));
+
+    //
+    // message_ring
+    //
+
+    using ring_msgs = std::tuple<ring_order, ring_text, ring_wide>;
+    using small_ring = message_ring<ring_msgs, 512>;
+    EXPECT_EQ((small_ring::record_size<ring_order>()), (64));
+    EXPECT_EQ((small_ring::record_size<ring_wide>()), (192));
+    EXPECT_SAME((small_ring::tag_type), (uint8_t));
+
+    // Tags, in order, then the sequence numbers summed by type
+    struct ring_seen {
+        std::string tags;
+        int64_t     sum = 0;
+        void operator()(ring_order& m) { tags += 'o'; sum += m.seq + m.px; }
+        void operator()(ring_text& m)  { tags += 't'; sum += m.seq + int64_t(m.text.size()); }
+        void operator()(ring_wide& m)  { tags += 'w'; sum += m.seq + m.fill[19]; }
+    };
+
+    {
+        small_ring ring;
+        ring_seen seen;
+        EXPECT_EQ((ring.consume(seen)), (false));
+        ring.push<ring_order>(ring_order{1, 100});
+        ring.push<ring_text>(ring_text{2, std::string(50, 'x')});
+        EXPECT_EQ((ring.size_bytes()), (128));
+        EXPECT_EQ((ring.consume(seen)), (true));
+        EXPECT_EQ((seen.tags), (std::string("o")));
+
+        // Staged messages are not visible before publish
+        EXPECT_EQ((ring.try_stage<ring_wide>(ring_wide{3, {}})), (true));
+        EXPECT_EQ((ring.try_stage<ring_order>(ring_order{4, 0})), (true));
+        EXPECT_EQ((ring.consume_all(seen)), (1));
+        ring.publish();
+        EXPECT_EQ((ring.consume_all(seen)), (2));
+        EXPECT_EQ((seen.tags), (std::string("otwo")));
+
+        // 448 bytes in, a 192 byte record goes to the start behind 64 bytes of
+        // padding, and a second one fills the ring
+        ring.push<ring_order>(ring_order{5, 0});
+        EXPECT_EQ((ring.try_push<ring_wide>(ring_wide{8, {}})), (true));
+        EXPECT_EQ((ring.size_bytes()), (64 + 64 + 192));
+        EXPECT_EQ((ring.try_push<ring_wide>(ring_wide{9, {}})), (true));
+        EXPECT_EQ((ring.try_push<ring_order>(ring_order{10, 0})), (false));
+        EXPECT_EQ((ring.consume_all(seen, 2)), (2));
+        EXPECT_EQ((ring.consume_all(seen)), (1));
+        EXPECT_EQ((seen.tags), (std::string("otwooww")));
+        EXPECT_EQ((seen.sum), (1 + 100 + 2 + 50 + 3 + 4 + 5 + 8 + 9));
+
+        // Left for the destructor
+        ring.push<ring_text>(ring_text{11, std::string(100, 'y')});
+        ring.try_stage<ring_text>(ring_text{12, std::string(100, 'z')});
+    }
 
-    EXPECT_SAME((sorted_t<seq_t<int, 4, 1, 2, 8>>), (seq_t<int, 1, 2, 4, 8>));
-    EXPECT_SAME((sorted_t<seq_t<int, 8, 4, 2, 1, 1, 8>>), (seq_t<int, 1, 1, 2, 4, 8, 8>));
+    // A throwing visit still destroys its message and moves past it
+    {
+        small_ring ring;
+        ring.push<ring_text>(ring_text{1, std::string(100, 'a')});
+        ring.push<ring_text>(ring_text{2, std::string(100, 'b')});
+        bool ring_threw = false;
+        try {
+            ring.consume([](auto&) { throw std::runtime_error("visit"); });
+        } catch (const std::runtime_error&) {
+            ring_threw = true;
+        }
+        ring_seen seen;
+        EXPECT_EQ((ring_threw), (true));
+        EXPECT_EQ((ring.consume_all(seen)), (1));
+        EXPECT_EQ((seen.sum), (2 + 100));
+    }
+
+    // Producer and consumer threads, order kept
+    {
+        message_ring<ring_msgs, 4096> ring;
+        constexpr int64_t ring_count = 100000;
+        std::thread producer([&ring] {
+            for (int64_t i = 0; i < ring_count; ++i) {
+                switch (i % 3) {
+                case 0: ring.stage<ring_order>(ring_order{i, 1}); break;
+                case 1: ring.stage<ring_text>(ring_text{i, std::to_string(i)}); break;
+                case 2: ring.stage<ring_wide>(ring_wide{i, {}}); break;
+                }
+                if (i % 8 == 7) ring.publish();
+            }
+            ring.publish();
+        });
+        int64_t next = 0;
+        bool in_order = true;
+        auto check = [&](auto& m) {
+            in_order = in_order && m.seq == next;
+            ++next;
+        };
+        while (next < ring_count) {
+            if (ring.consume_all(check) == 0) std::this_thread::yield();
+        }
+        producer.join();
+        EXPECT_EQ((in_order), (true));
+        EXPECT_EQ((ring.size_bytes()), (0));
+    }
 
     return test_mgr.report();
 }
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "type_util.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace t {
+
+// Who may call a typed_pool
+//  single - one thread, no locking
+//  shared - any thread, each through its own typed_pool::cache, which moves blocks
+//           to and from the pool in batches under its lock. Direct calls lock too.
+
+enum class pool_mode { single, shared };
+
+namespace detail {
+
+// Block geometry of T - room and alignment for T, and for the free list link kept in
+// a free block. Types of one geometry share a class.
+template <class T>
+struct pool_block {
+    static constexpr size_t align = std::max(alignof(T), alignof(void*));
+    static constexpr size_t size  = (std::max(sizeof(T), sizeof(void*)) + align - 1) / align * align;
+};
+
+// Class key - size and alignment in one sortable value
+template <class T>
+struct pool_class_key {
+    static constexpr uint64_t value = uint64_t(pool_block<T>::size) << 16 | pool_block<T>::align;
+};
+
+// Blocks a slab of a class holds, and a cache moves at once
+inline constexpr size_t pool_slab_bytes  = 1 << 16;
+inline constexpr size_t pool_cache_bytes = 1 << 12;
+
+struct pool_null_lock {
+    explicit pool_null_lock(std::mutex&) {}
+};
+
+} // namespace detail
+
+// Pool of blocks for the types of a tuple, one free list per size class. The classes
+// are the distinct block geometries of the types, sorted - allocate<T> picks T's class
+// at compile time, so a call is a pop from one list. Slabs of blocks are added as a
+// class runs out and freed with the pool; blocks never move between classes.
+//
+//     typed_pool<std::tuple<order, cancel, fill>> pool;
+//     order* o = pool.create<order>(id, px, qty);
+//     ...
+//     pool.destroy(o);
+//
+// Statistics per class count the blocks out of the pool, and their high water mark.
+// With pool_mode::shared, blocks held by thread caches count as out.
+
+template <class List, pool_mode Mode = pool_mode::single> class typed_pool;
+
+template <class... Ts, pool_mode Mode>
+class typed_pool<std::tuple<Ts...>, Mode> {
+    using list_t = std::tuple<Ts...>;
+
+public:
+    // Class keys, (block size << 16) | block alignment, ascending
+    using classes = unique_t<sorted_t<keys_t<list_t, detail::pool_class_key>>>;
+
+    static constexpr size_t class_count = size_v<classes>;
+
+    template <class T>
+    static constexpr size_t class_of() {
+        static_assert(find_v<list_t, T> != sizeof...(Ts), "typed_pool: type is not in the list");
+        return find_v<classes, seq_t<typename classes::value_type, detail::pool_class_key<T>::value>>;
+    }
+
+    static constexpr size_t block_size(size_t c)  { return size_t(to_array_v<classes>[c] >> 16); }
+    static constexpr size_t block_align(size_t c) { return size_t(to_array_v<classes>[c] & 0xffff); }
+
+    static constexpr size_t slab_blocks(size_t c) {
+        return std::max<size_t>(16, detail::pool_slab_bytes / block_size(c));
+    }
+
+    struct class_stats {
+        size_t block_size  = 0;
+        size_t block_align = 0;
+        size_t out         = 0;   // blocks out of the pool now
+        size_t high_water  = 0;   // most blocks out at once
+        size_t slabs       = 0;
+        size_t allocations = 0;   // blocks taken from the pool, all time
+    };
+
+    typed_pool() = default;
+    typed_pool(const typed_pool&)            = delete;
+    typed_pool& operator=(const typed_pool&) = delete;
+
+    ~typed_pool() {
+        for (size_t c = 0; c < class_count; ++c) {
+            for (void* slab : classes_[c].slabs) {
+                ::operator delete(slab, std::align_val_t(block_align(c)));
+            }
+        }
+    }
+
+    // Storage for one T - uninitialized
+    template <class T>
+    T* allocate() {
+        constexpr size_t c = class_of<T>();
+        lock_t lock(mutex_);
+        return static_cast<T*>(take(c));
+    }
+
+    template <class T>
+    void deallocate(T* p) {
+        constexpr size_t c = class_of<T>();
+        lock_t lock(mutex_);
+        give(c, p);
+    }
+
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+        T* p = allocate<T>();
+        try {
+            return new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(p);
+            throw;
+        }
+    }
+
+    template <class T>
+    void destroy(T* p) {
+        p->~T();
+        deallocate(p);
+    }
+
+    class_stats stats(size_t c) const {
+        lock_t lock(mutex_);
+        const class_state& s = classes_[c];
+        return {block_size(c), block_align(c), s.out, s.high_water, s.slabs.size(), s.allocations};
+    }
+
+    template <class T>
+    class_stats stats() const { return stats(class_of<T>()); }
+
+    // Per thread front of a shared pool - allocate and deallocate touch only its own
+    // lists, and take or return a batch of blocks under the pool's lock when a list
+    // runs empty or grows past two batches. Returns its blocks when destroyed.
+    class cache;
+
+private:
+    struct node {
+        node* next;
+    };
+
+    struct class_state {
+        node*              free        = nullptr;
+        size_t             out         = 0;
+        size_t             high_water  = 0;
+        size_t             allocations = 0;
+        std::vector<void*> slabs;
+    };
+
+    using lock_t = std::conditional_t<Mode == pool_mode::shared,
+                                      std::lock_guard<std::mutex>, detail::pool_null_lock>;
+
+    std::array<class_state, class_count> classes_;
+    mutable std::mutex                   mutex_;
+
+    void grow(size_t c) {
+        const size_t size = block_size(c), count = slab_blocks(c);
+        std::vector<void*>& slabs = classes_[c].slabs;
+        if (slabs.size() == slabs.capacity()) slabs.reserve(2 * slabs.size() + 1);   // push_back cannot throw
+        auto* slab = static_cast<std::byte*>(::operator new(size * count, std::align_val_t(block_align(c))));
+        slabs.push_back(slab);
+        node* head = classes_[c].free;
+        for (size_t i = count; i-- > 0; ) head = new (slab + i * size) node{head};
+        classes_[c].free = head;
+    }
+
+    void* take(size_t c) {
+        class_state& s = classes_[c];
+        if (!s.free) grow(c);
+        node* n = s.free;
+        s.free = n->next;
+        s.high_water = std::max(s.high_water, ++s.out);
+        ++s.allocations;
+        return n;
+    }
+
+    void give(size_t c, void* p) {
+        class_state& s = classes_[c];
+        s.free = new (p) node{s.free};
+        --s.out;
+    }
+
+    // Batches for caches - count blocks onto / off a list. held counts each block as
+    // it is linked, so a take that throws leaves the list and its count in step.
+    void take_batch(size_t c, node*& head, size_t& held, size_t count) {
+        lock_t lock(mutex_);
+        for (size_t i = 0; i < count; ++i) {
+            void* p = take(c);
+            head = new (p) node{head};
+            ++held;
+        }
+    }
+
+    void give_batch(size_t c, node*& head, size_t count) {
+        lock_t lock(mutex_);
+        for (size_t i = 0; i < count && head; ++i) {
+            node* next = head->next;
+            give(c, head);
+            head = next;
+        }
+    }
+};
+
+template <class... Ts, pool_mode Mode>
+class typed_pool<std::tuple<Ts...>, Mode>::cache {
+    static_assert(Mode == pool_mode::shared, "typed_pool::cache needs pool_mode::shared");
+
+public:
+    static constexpr size_t batch(size_t c) {
+        return std::clamp<size_t>(detail::pool_cache_bytes / block_size(c), 4, 64);
+    }
+
+    explicit cache(typed_pool& pool) : pool_(pool) {}
+    cache(const cache&)            = delete;
+    cache& operator=(const cache&) = delete;
+
+    ~cache() {
+        for (size_t c = 0; c < class_count; ++c) pool_.give_batch(c, lists_[c].head, lists_[c].count);
+    }
+
+    template <class T>
+    T* allocate() {
+        constexpr size_t c = class_of<T>();
+        list& l = lists_[c];
+        if (!l.head) pool_.take_batch(c, l.head, l.count, batch(c));
+        node* n = l.head;
+        l.head = n->next;
+        --l.count;
+        return static_cast<T*>(static_cast<void*>(n));
+    }
+
+    template <class T>
+    void deallocate(T* p) {
+        constexpr size_t c = class_of<T>();
+        list& l = lists_[c];
+        l.head = new (static_cast<void*>(p)) node{l.head};
+        if (++l.count > 2 * batch(c)) {
+            pool_.give_batch(c, l.head, batch(c));
+            l.count -= batch(c);
+        }
+    }
+
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+        T* p = allocate<T>();
+        try {
+            return new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(p);
+            throw;
+        }
+    }
+
+    template <class T>
+    void destroy(T* p) {
+        p->~T();
+        deallocate(p);
+    }
+
+    // Blocks held for class c
+    size_t cached(size_t c) const { return lists_[c].count; }
+
+private:
+    struct list {
+        node*  head  = nullptr;
+        size_t count = 0;
+    };
+
+    typed_pool&                   pool_;
+    std::array<list, class_count> lists_;
+};
+
+}  // namespace t
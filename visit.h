@@ -0,0 +1,210 @@
+#pragma once
+
+#include "type_util.h"
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace t {
+
+// Default out of range policy of visit_index
+
+struct throw_out_of_range {
+    [[noreturn]] void operator()(size_t) const {
+        throw std::out_of_range("t::visit_index: index out of range");
+    }
+};
+
+namespace detail {
+
+// Calls an error handler - visit_index's on_error, with_value's on_missing - and
+// gives its result. A void handler must not return when there is a result to give:
+// if it does, Fallback throws.
+template <class Result, class Fallback, class Handler, class Arg>
+Result call_error_handler(Handler& handler, Arg arg) {
+    if constexpr (std::is_void_v<Result>) {
+        std::forward<Handler>(handler)(arg);
+    } else if constexpr (std::is_void_v<decltype(std::declval<Handler>()(arg))>) {
+        std::forward<Handler>(handler)(arg);
+        Fallback{}(arg);
+    } else {
+        return std::forward<Handler>(handler)(arg);
+    }
+}
+
+// One function per type, plus one for out of range at the end.
+// The index is clamped to the last entry, so the call is a single indirect jump.
+
+template <class List, class F, class OnError, class _Is = std::make_index_sequence<size_v<List>>>
+struct visit_table;
+
+template <class List, class F, class OnError, size_t... Is>
+struct visit_table<List, F, OnError, std::index_sequence<Is...>> {
+    static_assert(sizeof...(Is) != 0, "visit_index needs at least one type");
+
+    using result_t = decltype(std::declval<F>()(type_tag<select_t<0, List>>{}));
+    static_assert((std::is_same_v<result_t,
+                        decltype(std::declval<F>()(type_tag<select_t<int(Is), List>>{}))> && ...),
+                  "visit_index needs the same return type for every type");
+
+    template <size_t I>
+    static result_t call(F& f, OnError&, size_t) {
+        return std::forward<F>(f)(type_tag<select_t<int(I), List>>{});
+    }
+
+    static result_t out_of_range(F&, OnError& on_error, size_t idx) {
+        return call_error_handler<result_t, throw_out_of_range, OnError>(on_error, idx);
+    }
+
+    using entry_t = result_t (*)(F&, OnError&, size_t);
+    static constexpr entry_t table[sizeof...(Is) + 1] = {&call<Is>..., &out_of_range};
+
+    static constexpr result_t visit(size_t idx, F& f, OnError& on_error) {
+        return table[idx < sizeof...(Is) ? idx : sizeof...(Is)](f, on_error, idx);
+    }
+};
+
+} // namespace detail
+
+// Call f(type_tag<select_t<idx, List>>{}) for a runtime idx, through a table of
+// function pointers - one indirect call, whatever the size of List.
+// Every call must return the same type.
+// Out of range: on_error(idx) is called instead and its result returned. The default
+// throws std::out_of_range. A handler returning void, used where f returns a value,
+// must not return - if it does, std::out_of_range is thrown after it.
+
+template <class List, class F, class OnError = throw_out_of_range>
+constexpr decltype(auto) visit_index(size_t idx, F&& f, OnError&& on_error = {}) {
+    return detail::visit_table<List, F, OnError>::visit(idx, f, on_error);
+}
+
+// Variant over the types of a tuple, with the smallest discriminator that holds the
+// index - uint8_t for up to 256 types.
+// Never empty - default constructs the first type, and alternatives must be nothrow
+// move constructible so assignment cannot leave it without a value.
+
+template <class List> class variant_of;
+
+template <class... Ts>
+class variant_of<std::tuple<Ts...>> {
+    static_assert(sizeof...(Ts) != 0, "variant_of needs at least one type");
+    static_assert((std::is_nothrow_move_constructible_v<Ts> && ...),
+                  "variant_of types must be nothrow move constructible");
+
+public:
+    using types      = std::tuple<Ts...>;
+    using index_type = uint_for_t<sizeof...(Ts) - 1>;
+
+    template <class T>
+    static constexpr size_t index_of = find_v<types, T>;
+
+    variant_of() : index_(0) {
+        ::new (static_cast<void*>(storage_)) select_t<0, types>();
+    }
+
+    template <class T, class... Args, class = std::enable_if_t<index_of<T> != sizeof...(Ts)>>
+    explicit variant_of(std::in_place_type_t<T>, Args&&... args) : index_(index_of<T>) {
+        ::new (static_cast<void*>(storage_)) T(std::forward<Args>(args)...);
+    }
+
+    template <class U, class T = std::decay_t<U>,
+              class = std::enable_if_t<index_of<T> != sizeof...(Ts)>>
+    variant_of(U&& v) : variant_of(std::in_place_type<T>, std::forward<U>(v)) {}
+
+    variant_of(const variant_of& other) : index_(other.index_) {
+        other.visit([this](const auto& v) {
+            ::new (static_cast<void*>(storage_)) std::decay_t<decltype(v)>(v);
+        });
+    }
+
+    variant_of(variant_of&& other) noexcept : index_(other.index_) {
+        other.visit([this](auto& v) {
+            ::new (static_cast<void*>(storage_)) std::decay_t<decltype(v)>(std::move(v));
+        });
+    }
+
+    variant_of& operator=(const variant_of& other) {
+        if (this != &other) *this = variant_of(other);
+        return *this;
+    }
+
+    variant_of& operator=(variant_of&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            index_ = other.index_;
+            other.visit([this](auto& v) {
+                ::new (static_cast<void*>(storage_)) std::decay_t<decltype(v)>(std::move(v));
+            });
+        }
+        return *this;
+    }
+
+    ~variant_of() { destroy(); }
+
+    size_t index() const { return index_; }
+
+    template <class T>
+    bool holds() const { return index_ == index_of<T>; }
+
+    // Constructs the new value before destroying the old one, unless that cannot throw
+    template <class T, class... Args>
+    T& emplace(Args&&... args) {
+        static_assert(index_of<T> != sizeof...(Ts), "type is not one of the variant's types");
+        if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+            destroy();
+            ::new (static_cast<void*>(storage_)) T(std::forward<Args>(args)...);
+        } else {
+            T tmp(std::forward<Args>(args)...);
+            destroy();
+            ::new (static_cast<void*>(storage_)) T(std::move(tmp));
+        }
+        index_ = index_type(index_of<T>);
+        return *std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    template <class T>
+    T* get_if() {
+        return holds<T>() ? std::launder(reinterpret_cast<T*>(storage_)) : nullptr;
+    }
+
+    template <class T>
+    const T* get_if() const {
+        return holds<T>() ? std::launder(reinterpret_cast<const T*>(storage_)) : nullptr;
+    }
+
+    // f(T&) for the current T
+    template <class F>
+    decltype(auto) visit(F&& f) {
+        return visit_index<types>(index_, [&](auto tag) -> decltype(auto) {
+            using T = typename decltype(tag)::type;
+            return std::forward<F>(f)(*std::launder(reinterpret_cast<T*>(storage_)));
+        });
+    }
+
+    template <class F>
+    decltype(auto) visit(F&& f) const {
+        return visit_index<types>(index_, [&](auto tag) -> decltype(auto) {
+            using T = typename decltype(tag)::type;
+            return std::forward<F>(f)(*std::launder(reinterpret_cast<const T*>(storage_)));
+        });
+    }
+
+private:
+    void destroy() {
+        visit([](auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            v.~T();
+        });
+    }
+
+    static constexpr size_t storage_size = std::max({sizeof(Ts)...});
+
+    alignas(Ts...) unsigned char storage_[storage_size];
+    index_type index_;
+};
+
+}  // namespace t
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "type_util.h"
+#include "perfect_hash.h"
+#include "visit.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace t {
+
+// How with_value finds the constant for a runtime value
+//  jump_table   - one indirect call through a table indexed by x - min, when the
+//                 values span a small range
+//  binary_tree  - nested compares against the sorted values, inlined into the
+//                 caller, f included
+//  perfect_hash - a multiplicative hash without collisions, one compare and one
+//                 indirect call, for many values spread wide
+
+enum class value_dispatch { jump_table, binary_tree, perfect_hash };
+
+// Default policy for a value that is not in the sequence
+
+struct throw_missing_value {
+    template <class T>
+    [[noreturn]] void operator()(T) const {
+        throw std::out_of_range("t::with_value: value not in the sequence");
+    }
+};
+
+namespace detail {
+
+inline constexpr size_t value_dispatch_tree_max = 64;
+
+// Sorted distinct values, their range and their perfect hash.
+// A primary template over the sequence type, so reading its arrays costs the same
+// for 10 values or 10k.
+
+template <class Seq>
+struct value_dispatch_info {
+    using value_type = typename Seq::value_type;
+    using unsigned_t = std::make_unsigned_t<value_type>;
+    static_assert(std::is_integral_v<value_type>, "with_value needs a sequence of integers");
+
+    using values = sorted_t<unique_t<Seq>>;
+    static constexpr size_t n = size_v<values>;
+    static constexpr auto&  a = to_array_v<values>;
+
+    static constexpr value_type lo = n ? a[0] : value_type();
+    static constexpr uint64_t span = n ? uint64_t(unsigned_t(unsigned_t(a[n - 1]) - unsigned_t(lo))) : 0;
+
+    // Jump table slots - only worth it while mostly full
+    static constexpr bool   dense = n != 0 && span < std::max<uint64_t>(64, 4 * n);
+    static constexpr size_t range = dense ? size_t(span) + 1 : 0;
+
+    static constexpr size_t offset(value_type x) {
+        return size_t(unsigned_t(unsigned_t(x) - unsigned_t(lo)));
+    }
+
+    // Hashed for many values spread wide - the hash is only built for those
+    using hash = perfect_hash<values>;
+    static constexpr bool hashed =
+        std::conjunction_v<std::bool_constant<(!dense && n > value_dispatch_tree_max)>,
+                           hash_found<hash>>;
+
+    static constexpr value_dispatch best =
+        dense  ? value_dispatch::jump_table   :
+        hashed ? value_dispatch::perfect_hash :
+                 value_dispatch::binary_tree;
+};
+
+template <class Seq, class F, class OnMissing>
+struct value_dispatcher {
+    using info       = value_dispatch_info<Seq>;
+    using value_type = typename info::value_type;
+
+    static constexpr size_t n = info::n;
+    static constexpr auto&  a = info::a;
+
+    template <value_type V>
+    using constant = std::integral_constant<value_type, V>;
+
+    using result_t = decltype(std::declval<F>()(constant<n ? a[0] : value_type()>{}));
+
+    template <value_type V>
+    static result_t call(F& f, OnMissing&, value_type) {
+        static_assert(std::is_same_v<result_t, decltype(std::declval<F>()(constant<V>{}))>,
+                      "with_value needs the same return type for every value");
+        return std::forward<F>(f)(constant<V>{});
+    }
+
+    static result_t missing(F&, OnMissing& on_missing, value_type x) {
+        return call_error_handler<result_t, throw_missing_value, OnMissing>(on_missing, x);
+    }
+
+    using entry_t = result_t (*)(F&, OnMissing&, value_type);
+
+    // jump_table - slot x - lo, clamped to the missing entry at the end
+
+    template <size_t J>
+    static constexpr entry_t jump_entry() {
+        constexpr value_type v = value_type(unsigned_add(info::lo, J));
+        if constexpr (J < info::range && find_sorted(v)) return &call<v>;
+        else                                            return &missing;
+    }
+
+    static constexpr value_type unsigned_add(value_type lo, size_t j) {
+        using u = typename info::unsigned_t;
+        return value_type(u(u(lo) + u(j)));
+    }
+
+    static constexpr bool find_sorted(value_type v) {
+        size_t lo = 0, hi = n;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (a[mid] < v) lo = mid + 1;
+            else            hi = mid;
+        }
+        return lo < n && a[lo] == v;
+    }
+
+    template <size_t... Js>
+    static constexpr std::array<entry_t, sizeof...(Js)> make_jump(std::index_sequence<Js...>) {
+        return {jump_entry<Js>()...};
+    }
+
+    static constexpr std::array<entry_t, info::range + 1> jump =
+        make_jump(std::make_index_sequence<info::range + 1>{});
+
+    // perfect_hash - the key compare picks the slot's entry or the missing one past
+    // the end
+
+    template <size_t S>
+    static constexpr entry_t hash_entry() {
+        using hash = typename info::hash;
+        if constexpr (S < hash::slots && hash::value.slot_index[S] != n) {
+            return &call<a[hash::value.slot_index[S]]>;
+        } else {
+            return &missing;
+        }
+    }
+
+    template <size_t... Ss>
+    static constexpr std::array<entry_t, sizeof...(Ss)> make_hash(std::index_sequence<Ss...>) {
+        return {hash_entry<Ss>()...};
+    }
+
+    static constexpr std::array<entry_t, info::hash::slots + 1> hashed =
+        make_hash(std::make_index_sequence<info::hash::slots + 1>{});
+
+    // binary_tree over a[L, R)
+
+    template <size_t L, size_t R>
+    static result_t tree(value_type x, F& f, OnMissing& on_missing) {
+        if constexpr (R - L == 0) {
+            return missing(f, on_missing, x);
+        } else if constexpr (R - L == 1) {
+            if (x == a[L]) return call<a[L]>(f, on_missing, x);
+            return missing(f, on_missing, x);
+        } else {
+            constexpr size_t M = (L + R) / 2;
+            if (x < a[M]) return tree<L, M>(x, f, on_missing);
+            return tree<M, R>(x, f, on_missing);
+        }
+    }
+
+    template <value_dispatch Kind>
+    static result_t dispatch(value_type x, F& f, OnMissing& on_missing) {
+        if constexpr (Kind == value_dispatch::jump_table) {
+            static_assert(info::dense, "values span too wide for a jump table");
+            size_t j = info::offset(x);
+            return jump[j < info::range ? j : info::range](f, on_missing, x);
+        } else if constexpr (Kind == value_dispatch::perfect_hash) {
+            using hash = typename info::hash;
+            static_assert(hash::value.found, "no perfect hash for these values - see value_dispatch_v");
+            size_t s = hash::slot_of(x);
+            return hashed[hash::keys[s] == x ? s : hash::slots](f, on_missing, x);
+        } else {
+            return tree<0, n>(x, f, on_missing);
+        }
+    }
+};
+
+} // namespace detail
+
+// The dispatch with_value uses for a sequence - jump_table for values in a small
+// range, binary_tree for up to 64 values, perfect_hash past that, binary_tree again
+// if no hash is found
+
+template <class Seq>
+inline constexpr value_dispatch value_dispatch_v = detail::value_dispatch_info<Seq>::best;
+
+// Call f(std::integral_constant<T, V>{}) for the V of Seq, a seq_t<T, ...>, equal to
+// the runtime x - a kernel specialized per value, like a field width or a decimal
+// scale, chosen once outside its loop.
+//
+//     with_value<seq_t<int, 2, 4, 8>>(width, [&](auto w) { pack<w.value>(in, out); });
+//
+// Every call must return the same type.
+// x not in Seq: on_missing(x) is called instead and its result returned. The default
+// throws std::out_of_range. A handler returning void, used where f returns a value,
+// must not return - if it does, std::out_of_range is thrown after it.
+// Kind overrides the choice, mostly for testing and benchmarks.
+
+template <class Seq, value_dispatch Kind = value_dispatch_v<Seq>, class F,
+          class OnMissing = throw_missing_value>
+decltype(auto) with_value(typename Seq::value_type x, F&& f, OnMissing&& on_missing = {}) {
+    return detail::value_dispatcher<Seq, F, OnMissing>::template dispatch<Kind>(x, f, on_missing);
+}
+
+}  // namespace t